@@ -1,2 +1,6 @@
 #pragma once
-#include "jobs/job_system.h"
\ No newline at end of file
+#include "jobs/job_system.h"
+#include "jobs/batch_job.h"
+#include "jobs/parallel_algorithms.h"
+#include "jobs/parallel_pipeline.h"
+#include "jobs/task_arena.h"
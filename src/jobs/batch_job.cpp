@@ -0,0 +1,92 @@
+#include "batch_job.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    namespace
+    {
+        size_t greatest_common_divisor(size_t pLeft, size_t pRight)
+        {
+            while (pRight != 0)
+            {
+                size_t remainder = pLeft % pRight;
+                pLeft = pRight;
+                pRight = remainder;
+            }
+            return pLeft;
+        }
+
+        size_t least_common_multiple(size_t pLeft, size_t pRight)
+        {
+            return pLeft / greatest_common_divisor(pLeft, pRight) * pRight;
+        }
+    }
+
+    batch_partition::batch_partition(size_t pCount, std::initializer_list<batch_span> pSpans,
+                                     size_t pChunkCount, size_t pMinChunkElements)
+        : mCount(pCount)
+        , mGrain(1)
+        , mHead(0)
+        , mTailBegin(pCount)
+        , mChunkGrains(0)
+        , mChunkCount(1)
+        , mAligned(false)
+    {
+        // Smallest element count that is a whole number of cache lines in every span
+        for (const auto &span : pSpans)
+        {
+            size_t elementSize = std::max<size_t>(span.mElementSize, 1);
+            mGrain = least_common_multiple(mGrain, kCacheLineSize / greatest_common_divisor(elementSize, kCacheLineSize));
+        }
+
+        // Skip elements up to the first cache line boundary of the first span
+        if (pSpans.size() > 0)
+        {
+            const batch_span &primary = *pSpans.begin();
+            size_t elementSize = std::max<size_t>(primary.mElementSize, 1);
+            size_t offset = reinterpret_cast<uintptr_t>(primary.mData) % kCacheLineSize;
+            size_t gap = (kCacheLineSize - offset) % kCacheLineSize;
+
+            // Elements straddling cache lines can not be aligned, then only the chunk size is kept
+            if (gap % elementSize == 0)
+            {
+                mHead = std::min(gap / elementSize, pCount);
+                mAligned = true;
+            }
+        }
+
+        // The other spans are aligned too if their first chunk element starts a cache line
+        for (const auto &span : pSpans)
+        {
+            uintptr_t bodyStart = reinterpret_cast<uintptr_t>(span.mData) + mHead * span.mElementSize;
+            mAligned = mAligned && bodyStart % kCacheLineSize == 0;
+        }
+
+        size_t grains = (pCount - mHead) / mGrain;
+        mTailBegin = mHead + grains * mGrain;
+        if (grains == 0)
+        {
+            mChunkGrains = 0;
+            return;
+        }
+
+        // As many chunks as requested, but none smaller than the minimum
+        size_t minGrains = std::max<size_t>((pMinChunkElements + mGrain - 1) / mGrain, 1);
+        size_t chunks = std::max<size_t>(std::min(std::max<size_t>(pChunkCount, 1), grains / minGrains), 1);
+        mChunkGrains = (grains + chunks - 1) / chunks;
+        mChunkCount = (grains + mChunkGrains - 1) / mChunkGrains;
+    }
+
+    batch_range batch_partition::chunk(size_t pIndex) const
+    {
+        size_t begin = std::min(mHead + pIndex * mChunkGrains * mGrain, mTailBegin);
+        size_t end = std::min(begin + mChunkGrains * mGrain, mTailBegin);
+        return batch_range{begin, end};
+    }
+
+    } // namespace jobs
+} // namespace cacau
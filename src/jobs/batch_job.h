@@ -0,0 +1,250 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "job_system.h"
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    constexpr size_t kCacheLineSize = 64;
+
+    /**
+     * @brief Address and element size of one contiguous array processed by a batch job
+     */
+    struct batch_span
+    {
+        const void* mData;
+        size_t mElementSize;
+    };
+
+    template <typename T>
+    batch_span make_batch_span(const T* pData)
+    {
+        return batch_span{pData, sizeof(T)};
+    }
+
+    /**
+     * @brief Half-open element range [mBegin, mEnd)
+     */
+    struct batch_range
+    {
+        size_t mBegin;
+        size_t mEnd;
+
+        size_t size() const { return mEnd - mBegin; }
+        bool empty() const { return mBegin == mEnd; }
+    };
+
+    /**
+     * @brief Splits an index range into cache-line-aligned chunks
+     * @details Chunk boundaries fall on cache-line boundaries of every span, so no two chunks
+     *          share a cache line, and every chunk body is a whole number of cache lines, which is
+     *          also a multiple of any SIMD width up to 64 bytes. The head is computed from the
+     *          first span, another span is aligned when its element at head().mEnd also starts a
+     *          cache line (e.g. all spans allocated 64-byte aligned), aligned() checks every span.
+     *          The unaligned prefix (head) belongs to the first chunk and the remainder (tail) to
+     *          the last one
+     */
+    class batch_partition
+    {
+    public:
+        /**
+         * @param pCount Number of elements in every span
+         * @param pSpans Arrays processed together, at least one
+         * @param pChunkCount Desired number of chunks, fewer are made if there is not enough work
+         * @param pMinChunkElements Smallest chunk body worth a job of its own
+         */
+        batch_partition(size_t pCount, std::initializer_list<batch_span> pSpans,
+                        size_t pChunkCount, size_t pMinChunkElements = 1024);
+
+        size_t count() const { return mCount; }
+        size_t chunk_count() const { return mChunkCount; }
+
+        /**
+         * @brief Elements per cache-line-aligned granule, chunk bodies are multiples of it
+         */
+        size_t grain() const { return mGrain; }
+
+        /**
+         * @brief Unaligned elements before the first aligned granule, processed by chunk 0
+         */
+        batch_range head() const { return batch_range{0, mHead}; }
+
+        /**
+         * @brief Remaining elements after the last whole granule, processed by the last chunk
+         */
+        batch_range tail() const { return batch_range{mTailBegin, mCount}; }
+
+        /**
+         * @brief Aligned body of a chunk, always a whole number of granules
+         */
+        batch_range chunk(size_t pIndex) const;
+
+        /**
+         * @brief Whether chunk bodies start on a cache line in every span, not only the first
+         * @details False when a span is offset differently from the first one inside a cache
+         *          line, or when the first span's elements straddle cache lines. Chunks then still
+         *          cover every element once, but neighbouring chunks may share cache lines
+         */
+        bool aligned() const { return mAligned; }
+
+    private:
+        size_t mCount;
+        size_t mGrain;
+        size_t mHead;
+        size_t mTailBegin;
+        size_t mChunkGrains;
+        size_t mChunkCount;
+        bool mAligned;
+    };
+
+    /**
+     * @brief Applies a kernel to contiguous arrays in parallel, one job per aligned chunk
+     * @details The partition is computed once, and chunk i is always submitted to the same
+     *          worker, so repeated dispatches (e.g. once per frame) find their data in that
+     *          core's cache. Idle workers may still steal chunks to balance load.
+     *          The kernel is called as kernel(begin, end) for every aligned chunk body, and
+     *          separately for the unaligned head and the scalar tail. It may be called
+     *          concurrently from several workers. dispatch() and wait() are called by one
+     *          thread, and the batch_job must outlive its waits
+     * @tparam Kernel Callable with signature void(size_t begin, size_t end)
+     */
+    template <typename Kernel = std::function<void(size_t, size_t)>>
+    class batch_job
+    {
+    public:
+        /**
+         * @param pJobSystem Job system executing the chunks
+         * @param pCount Number of elements in every span
+         * @param pKernel Function applied to every [begin, end) block
+         * @param pSpans Arrays the kernel reads or writes, used to align the chunks
+         * @param pMinChunkElements Smallest chunk body worth a job of its own
+         * @param pName Name of the chunk jobs (used in logging and statistics)
+         */
+        batch_job(job_system &pJobSystem, size_t pCount, Kernel pKernel,
+                  std::initializer_list<batch_span> pSpans,
+                  size_t pMinChunkElements = 1024, const char* pName = "BatchJob")
+            : mJobSystem(pJobSystem)
+            , mKernel(std::move(pKernel))
+            , mPartition(pCount, pSpans, pJobSystem.thread_count(), pMinChunkElements)
+            , mRemainingChunks(0)
+            , mName(pName) {}
+
+        /**
+         * @brief Submits one job per chunk, pinned to the same worker on every dispatch
+         */
+        void dispatch()
+        {
+            size_t chunkCount = mPartition.chunk_count();
+            std::shared_ptr<dispatch_state> state = std::make_shared<dispatch_state>(chunkCount);
+            mDispatches.push_back(state);
+            mRemainingChunks.fetch_add(chunkCount, std::memory_order_relaxed);
+            for (size_t i = 0; i < chunkCount; ++i)
+            {
+                // A job whose chunk was taken by wait() only touches the shared state
+                mJobSystem.submit_to(i % mJobSystem.thread_count(), new job([this, state, i]
+                {
+                    if (state->claim(i))
+                    {
+                        run_chunk(i);
+                    }
+                }, mName));
+            }
+        }
+
+        /**
+         * @brief Blocks until every chunk of every dispatch has run
+         * @details Runs the chunks no worker started yet on the calling thread, so waiting from
+         *          inside a job, or on a busy or paused job system, does not stall. The pause
+         *          state is left unchanged
+         */
+        void wait()
+        {
+            for (const std::shared_ptr<dispatch_state> &state : mDispatches)
+            {
+                for (size_t i = 0; i < state->mChunkCount; ++i)
+                {
+                    if (state->claim(i))
+                    {
+                        run_chunk(i);
+                    }
+                }
+            }
+            mDispatches.clear();
+
+            // Chunks claimed by workers are running
+            while (mRemainingChunks.load(std::memory_order_acquire) > 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        /**
+         * @brief Dispatches and waits
+         */
+        void run()
+        {
+            dispatch();
+            wait();
+        }
+
+        const batch_partition &partition() const { return mPartition; }
+
+    private:
+        /**
+         * @brief Chunks of one dispatch, each run by whoever claims it first: its job or wait()
+         */
+        struct dispatch_state
+        {
+            explicit dispatch_state(size_t pChunkCount)
+                : mChunkCount(pChunkCount)
+                , mClaimed(new std::atomic<bool>[pChunkCount]()) {}
+
+            bool claim(size_t pIndex)
+            {
+                return !mClaimed[pIndex].load(std::memory_order_relaxed) &&
+                       !mClaimed[pIndex].exchange(true, std::memory_order_acquire);
+            }
+
+            const size_t mChunkCount;
+            std::unique_ptr<std::atomic<bool>[]> mClaimed;
+        };
+
+        void run_chunk(size_t pIndex)
+        {
+            if (pIndex == 0)
+            {
+                call_kernel(mPartition.head());
+            }
+            call_kernel(mPartition.chunk(pIndex));
+            if (pIndex + 1 == mPartition.chunk_count())
+            {
+                call_kernel(mPartition.tail());
+            }
+            mRemainingChunks.fetch_sub(1, std::memory_order_release);
+        }
+
+        void call_kernel(const batch_range &pRange)
+        {
+            if (!pRange.empty())
+            {
+                mKernel(pRange.mBegin, pRange.mEnd);
+            }
+        }
+
+        job_system &mJobSystem;
+        Kernel mKernel;
+        batch_partition mPartition;
+        std::atomic<size_t> mRemainingChunks;
+        std::vector<std::shared_ptr<dispatch_state>> mDispatches; ///< Dispatched since the last wait()
+        const char* mName;
+    };
+
+    } // namespace jobs
+} // namespace cacau
@@ -0,0 +1,147 @@
+#pragma once
+#include <cstddef>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    /**
+     * @brief Fixed-size block allocator with per-thread caches
+     * @details Allocations and frees only touch the calling thread's cache. Blocks move to
+     *          and from a shared free list in batches, so a thread that only frees (a worker
+     *          deleting finished jobs) hands its surplus back to threads that only allocate.
+     *          Memory is kept for reuse and never returned to the system
+     * @tparam BlockSize Size of every block in bytes
+     * @tparam Alignment Alignment of every block
+     */
+    template <size_t BlockSize, size_t Alignment = alignof(std::max_align_t)>
+    class block_pool
+    {
+    public:
+        static_assert(Alignment <= alignof(std::max_align_t), "Over-aligned blocks are not supported");
+
+        static constexpr size_t kBatchSize = 64;
+
+        static void* allocate()
+        {
+            thread_cache &cache = local_cache();
+            if (cache.mHead == nullptr)
+            {
+                refill(cache);
+            }
+
+            free_block *block = cache.mHead;
+            cache.mHead = block->mNext;
+            --cache.mCount;
+            return block;
+        }
+
+        static void deallocate(void* pBlock)
+        {
+            thread_cache &cache = local_cache();
+            free_block *block = static_cast<free_block *>(pBlock);
+            block->mNext = cache.mHead;
+            cache.mHead = block;
+
+            // Hand a batch back once this thread holds more than it is likely to reuse
+            if (++cache.mCount > 2 * kBatchSize)
+            {
+                release_batch(cache);
+            }
+        }
+
+    private:
+        struct free_block
+        {
+            free_block *mNext;
+        };
+
+        static constexpr size_t kStride =
+            ((BlockSize < sizeof(free_block) ? sizeof(free_block) : BlockSize) + Alignment - 1) / Alignment * Alignment;
+
+        struct shared_state
+        {
+            std::mutex mMutex;
+            free_block *mHead = nullptr;
+        };
+
+        struct thread_cache
+        {
+            free_block *mHead = nullptr;
+            size_t mCount = 0;
+
+            ~thread_cache()
+            {
+                // Return everything, the blocks outlive the thread
+                while (mHead != nullptr)
+                {
+                    release_batch(*this);
+                }
+            }
+        };
+
+        static shared_state &shared()
+        {
+            // Intentionally leaked, thread caches may flush into it during static destruction
+            static shared_state *state = new shared_state();
+            return *state;
+        }
+
+        static thread_cache &local_cache()
+        {
+            static thread_local thread_cache cache;
+            return cache;
+        }
+
+        static void refill(thread_cache &pCache)
+        {
+            {
+                shared_state &state = shared();
+                std::lock_guard<std::mutex> lock(state.mMutex);
+                for (size_t i = 0; i < kBatchSize && state.mHead != nullptr; ++i)
+                {
+                    free_block *block = state.mHead;
+                    state.mHead = block->mNext;
+                    block->mNext = pCache.mHead;
+                    pCache.mHead = block;
+                    ++pCache.mCount;
+                }
+            }
+
+            if (pCache.mHead != nullptr)
+            {
+                return;
+            }
+
+            // Carve a new slab into blocks
+            char *slab = static_cast<char *>(::operator new(kStride * kBatchSize));
+            for (size_t i = 0; i < kBatchSize; ++i)
+            {
+                free_block *block = reinterpret_cast<free_block *>(slab + i * kStride);
+                block->mNext = pCache.mHead;
+                pCache.mHead = block;
+            }
+            pCache.mCount += kBatchSize;
+        }
+
+        static void release_batch(thread_cache &pCache)
+        {
+            shared_state &state = shared();
+            std::lock_guard<std::mutex> lock(state.mMutex);
+            for (size_t i = 0; i < kBatchSize && pCache.mHead != nullptr; ++i)
+            {
+                free_block *block = pCache.mHead;
+                pCache.mHead = block->mNext;
+                --pCache.mCount;
+                block->mNext = state.mHead;
+                state.mHead = block;
+            }
+        }
+    };
+
+    } // namespace jobs
+} // namespace cacau
@@ -0,0 +1,77 @@
+#include "execution_history.h"
+#include <cstdint>
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    namespace
+    {
+        // Adds pSample to a moving average, the first sample replaces the negative initial value
+        void blend(std::atomic<double> &pAverage, double pSample)
+        {
+            double average = pAverage.load(std::memory_order_relaxed);
+            pAverage.store(average < 0.0 ? pSample : average + execution_history::kWeight * (pSample - average),
+                           std::memory_order_relaxed);
+        }
+    }
+
+    size_t execution_history::home(const char* pName)
+    {
+        // Literals are at least byte aligned and often clustered, mix the address bits
+        uint64_t bits = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pName));
+        bits *= 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(bits >> 32) & (kCapacity - 1);
+    }
+
+    double execution_history::estimate(const char* pName) const
+    {
+        size_t index = home(pName);
+        for (size_t probe = 0; probe < kMaxProbes; ++probe, index = (index + 1) & (kCapacity - 1))
+        {
+            const char* name = mSlots[index].mName.load(std::memory_order_acquire);
+            if (name == nullptr)
+            {
+                break;
+            }
+            if (name == pName)
+            {
+                double average = mSlots[index].mAverage.load(std::memory_order_relaxed);
+                if (average >= 0.0)
+                {
+                    return average;
+                }
+                break;
+            }
+        }
+
+        // Unknown jobs count as an average job, or as one unit while there is no history at all
+        double average = mAverage.load(std::memory_order_relaxed);
+        return average < 0.0 ? 1.0 : average;
+    }
+
+    void execution_history::record(const char* pName, double pMicroseconds)
+    {
+        blend(mAverage, pMicroseconds);
+
+        size_t index = home(pName);
+        for (size_t probe = 0; probe < kMaxProbes; ++probe, index = (index + 1) & (kCapacity - 1))
+        {
+            slot &current = mSlots[index];
+            const char* name = current.mName.load(std::memory_order_acquire);
+            // A failed claim leaves the name that took the slot meanwhile in name
+            if (name == nullptr && current.mName.compare_exchange_strong(name, pName, std::memory_order_acq_rel))
+            {
+                name = pName;
+            }
+            if (name == pName)
+            {
+                blend(current.mAverage, pMicroseconds);
+                return;
+            }
+        }
+    }
+
+    } // namespace jobs
+} // namespace cacau
@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    /**
+     * @brief Moving-average execution time per job name, read and updated without locks
+     * @details Open-addressing table keyed by name pointer (names are expected to be string
+     *          literals). A name claims its slot once and keeps it; names that find no free slot
+     *          within kMaxProbes are estimated by the average of all jobs. Two workers updating
+     *          the same name at once may lose one sample, which only slows the average down
+     */
+    class execution_history
+    {
+    public:
+        static constexpr size_t kCapacity = 1024; ///< Power of two
+        static constexpr size_t kMaxProbes = 16;
+        static constexpr double kWeight = 0.25;   ///< Moving average weight of the newest sample
+
+        /**
+         * @brief Gets the average execution time of a job name in microseconds
+         * @return The average of all jobs for unknown names, 1 while nothing was recorded
+         */
+        double estimate(const char* pName) const;
+
+        /**
+         * @brief Adds an execution time sample in microseconds
+         */
+        void record(const char* pName, double pMicroseconds);
+
+    private:
+        struct slot
+        {
+            std::atomic<const char*> mName{nullptr};
+            std::atomic<double> mAverage{-1.0};  ///< Negative until the first sample is stored
+        };
+
+        static size_t home(const char* pName);
+
+        slot mSlots[kCapacity];
+        std::atomic<double> mAverage{-1.0};      ///< All jobs, negative until the first sample
+    };
+
+    } // namespace jobs
+} // namespace cacau
@@ -1,10 +1,31 @@
 #include "job.h"
+#include <algorithm>
+#include "block_pool.h"
 
 namespace cacau 
 {
     namespace jobs
     {
 
+        void* job::operator new(size_t pSize)
+        {
+            if (job_system_traits::kAllocatorPolicy == allocator_policy::pool && pSize == sizeof(job))
+            {
+                return block_pool<sizeof(job), alignof(job)>::allocate();
+            }
+            return ::operator new(pSize);
+        }
+
+        void job::operator delete(void* pJob, size_t pSize)
+        {
+            if (job_system_traits::kAllocatorPolicy == allocator_policy::pool && pSize == sizeof(job))
+            {
+                block_pool<sizeof(job), alignof(job)>::deallocate(pJob);
+                return;
+            }
+            ::operator delete(pJob);
+        }
+
         void job::execute()
         {
             LOG_MESSAGE(std::string(mName) + " Executing job " + std::string(mName));
@@ -12,11 +33,23 @@ namespace cacau
             {
                 mFunction();
             }
-            mIsFinished = true;
+            finish();
+            LOG_MESSAGE(std::string(mName) + " Exiting execute");
+        }
+
+        void job::skip()
+        {
+            LOG_MESSAGE(std::string(mName) + " Skipping job " + std::string(mName));
+            finish();
+        }
+
+        void job::finish()
+        {
+            mIsFinished.store(true, std::memory_order_release);
             {
+                // Resolving only queues the dependants, so the list can be walked in place
                 std::lock_guard<std::mutex> lock(mDependantsMutex);
-                auto dependants = mDependants;
-                for (auto *dependant : dependants)
+                for (auto *dependant : mDependants)
                 {
                     if (dependant == nullptr)
                     {
@@ -25,24 +58,31 @@ namespace cacau
                     }
                     if (!dependant->is_ready())
                     {
+                        // Forgotten before resolving, the dependant may be deleted once it runs
+                        if (job_system_traits::kPriorityQueues)
+                        {
+                            auto &priority = dependant->mPriority.get();
+                            std::lock_guard<std::mutex> dependencyLock(priority.mDependenciesMutex);
+                            auto &dependencies = priority.mDependencies;
+                            dependencies.erase(std::remove(dependencies.begin(), dependencies.end(), this),
+                                               dependencies.end());
+                        }
                         dependant->resolve_dependency(mName);
                     }
                 }
             }
-
-            LOG_MESSAGE(std::string(mName) + " Exiting execute");
         }
 
         bool job::add_dependant(job *pDependant)
         {
-            if (is_finished())
-            {
-                return false;
-            }
-
             {
+                // Checked under the lock finish() resolves the dependants with, so a dependant
+                // is either resolved by finish() or reported as already satisfied
                 std::lock_guard<std::mutex> lock(mDependantsMutex);
-                LOG_MESSAGE(std::string(mName) + " Attempting to lock m_dependants_mutex");
+                if (is_finished())
+                {
+                    return false;
+                }
 
                 LOG_MESSAGE(std::string(mName) + " Adding dependant " + std::string(pDependant->mName));
                 mDependants.push_back(pDependant);
@@ -57,6 +97,12 @@ namespace cacau
         void job::add_dependency(job *pDependency)
         {
             mRemainingDependencies.fetch_add(1, std::memory_order_relaxed);
+            // Only critical-path ranking walks the dependencies
+            if (job_system_traits::kPriorityQueues && pDependency != nullptr)
+            {
+                std::lock_guard<std::mutex> lock(mPriority.get().mDependenciesMutex);
+                mPriority.get().mDependencies.push_back(pDependency);
+            }
             LOG_MESSAGE(std::string(mName) + " Dependency added, remaining: " +
                         std::to_string(mRemainingDependencies.load()));
         }
@@ -70,7 +116,15 @@ namespace cacau
             if (remaining == 0)
             {
                 LOG_MESSAGE(std::string(mName) + " All dependencies resolved, " + mName + " is ready");
-                execute();
+                if (mOnReady)
+                {
+                    // Let the owner (usually the job system) schedule the job
+                    mOnReady();
+                }
+                else
+                {
+                    execute();
+                }
             }
         }
 
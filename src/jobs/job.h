@@ -1,12 +1,15 @@
 #pragma once
+#include <atomic>
 #include <functional>
 #include <iostream>
 #include <mutex>
 #include <string>
 #include <sstream>
 #include <chrono>
+#include <cstdint>
 #include <iomanip>
 #include <vector>
+#include "job_system_config.h"
 
 #ifdef CACAU_DEBUG
 #include <time.h>
@@ -17,6 +20,8 @@ namespace cacau
     namespace jobs
     {
 
+    class job_system;
+
     // Define CACAU_DEBUG to enable debug logging
     #ifdef CACAU_DEBUG
         static std::mutex mLogMutex;
@@ -56,12 +61,24 @@ namespace cacau
             , mRemainingDependencies(0)
             , mName(pName) {}
 
+        /**
+         * @brief Job allocation, served by block_pool when allocator_policy::pool is configured
+         */
+        static void* operator new(size_t pSize);
+        static void operator delete(void* pJob, size_t pSize);
+
         /**
          * @brief Executes the job's function and notifies dependent jobs
          * @details Thread-safe execution that handles dependency resolution
          */
         void execute();
 
+        /**
+         * @brief Marks the job as finished and notifies dependent jobs without running its function
+         * @details Used by the job system to drop jobs that missed their deadline
+         */
+        void skip();
+
         /**
          * @brief Adds a job that depends on this job's completion
          * @param dependant The job that depends on this one
@@ -78,6 +95,8 @@ namespace cacau
         /**
          * @brief Called when a dependency completes
          * @param caller Name of the completed dependency (for logging)
+         * @details When the last dependency resolves the on_ready callback is invoked,
+         *          or the job is executed inline if no callback is set
          */
         void resolve_dependency(const char* pCallSource);
 
@@ -89,17 +108,100 @@ namespace cacau
 
         // Status checks
         bool is_ready() const { return mRemainingDependencies.load(std::memory_order_relaxed) == 0; }
-        bool is_finished() const { return mIsFinished; }
+        bool is_finished() const { return mIsFinished.load(std::memory_order_acquire); }
         const char* name() const { return mName; }
 
+        /**
+         * @brief Groups the job's latency statistics under a user-defined type instead of its name
+         * @param pTypeId Non-zero type identifier, 0 (default) groups by name
+         */
+        void set_type_id(uint32_t pTypeId) { mTypeId = pTypeId; }
+        uint32_t type_id() const { return mTypeId; }
+
+        /**
+         * @brief Sets the time by which the job should have finished
+         * @details Ordered earliest-deadline-first in scheduling_mode::earliest_deadline.
+         *          Ignored when CACAU_JOBS_PRIORITY_QUEUES is 0, the job then has no deadline
+         */
+        void set_deadline(std::chrono::high_resolution_clock::time_point pDeadline)
+        {
+            if (job_system_traits::kPriorityQueues)
+            {
+                mPriority.get().mDeadline = pDeadline;
+                mPriority.get().mHasDeadline = true;
+            }
+        }
+        void clear_deadline()
+        {
+            if (job_system_traits::kPriorityQueues)
+            {
+                mPriority.get().mHasDeadline = false;
+            }
+        }
+        bool has_deadline() const { return job_system_traits::kPriorityQueues && mPriority.get().mHasDeadline; }
+        std::chrono::high_resolution_clock::time_point deadline() const
+        {
+            return job_system_traits::kPriorityQueues ? mPriority.get().mDeadline
+                                                      : std::chrono::high_resolution_clock::time_point();
+        }
+
+        /**
+         * @brief Estimated remaining critical-path length through this job, in microseconds
+         * @details Only assigned when the job system runs in critical-path scheduling mode. Ranks
+         *          raised by dependants registered later show once the job is queued
+         */
+        double rank() const
+        {
+            return job_system_traits::kPriorityQueues ? mPriority.get().mRank.load(std::memory_order_relaxed) : 0.0;
+        }
+
     private:
+        friend class job_system;
+
+        /**
+         * @brief Marks the job as finished and resolves its dependants
+         */
+        void finish();
+
+        /**
+         * @brief Deadline and critical-path state, compiled out with CACAU_JOBS_PRIORITY_QUEUES
+         */
+        struct priority_state
+        {
+            std::vector<job*> mDependencies;          ///< Unfinished jobs this one depends on
+            std::mutex mDependenciesMutex;           ///< Protects access to dependencies list
+            bool mHasDeadline = false;
+            bool mDeferred = false;                    ///< Already pushed back once for missing its deadline
+            std::chrono::high_resolution_clock::time_point mDeadline;
+            std::atomic<double> mRank{0.0};            ///< Heap key, only changed under the lock of the heap holding the job
+            std::atomic<double> mDownstreamRank{0.0};  ///< Highest rank among registered dependants
+            double mEstimate = 0.0;                    ///< Own execution time estimate, set before the job is queued
+            std::atomic<size_t> mRankedQueue{~size_t(0)}; ///< Worker whose ranked heap holds the job, ~0 if none
+        };
+
+        /**
+         * @brief Latency timestamps, compiled out with CACAU_JOBS_TRACING
+         */
+        struct tracing_state
+        {
+            std::chrono::high_resolution_clock::time_point mSubmitTime; ///< Set when latency tracking is on
+            std::chrono::high_resolution_clock::time_point mReadyTime;  ///< Set for dependent jobs when they become ready
+        };
+
         job_function mFunction;                    ///< The actual work to be performed
         std::atomic<int> mRemainingDependencies;  ///< Counter for unfinished dependencies
         std::function<void()> mOnReady;          ///< Callback for when job becomes ready
         std::vector<job*> mDependants;            ///< Jobs that depend on this one
         std::mutex mDependantsMutex;             ///< Protects access to dependants list
-        bool mIsFinished = false;                  ///< Indicates if job has completed
+        std::atomic<bool> mIsFinished{false};      ///< Indicates if job has completed
         const char* mName;                        ///< Job identifier
+        uint32_t mTypeId = 0;                      ///< Optional statistics grouping, 0 means by name
+
+        // Scheduler bookkeeping, owned by job_system
+        bool mDeleteOnCompletion = true;           ///< Plain submit() jobs are deleted after running
+        std::atomic<bool> mCompleted{false};       ///< Set last, once the worker no longer touches the job
+        feature_state<job_system_traits::kPriorityQueues, priority_state> mPriority;
+        feature_state<job_system_traits::kTracing, tracing_state> mTracing;
     };
 
     } // namespace jobs
@@ -1,4 +1,5 @@
 #include "job_system.h"
+#include <algorithm>
 #include <mutex>
 
 namespace cacau
@@ -7,11 +8,157 @@ namespace cacau
     {
     std::mutex execution_time_mutex;
 
-    job_system::job_system(size_t pThreadCount)
+    extern const int CACAU_JOBS_CONFIGURATION = 1;
+
+    namespace
+    {
+        using traits = job_system_traits;
+
+        // Identifies the worker running on the current thread, used to keep ready
+        // dependants on the worker that resolved them
+        thread_local const job_system *tCurrentJobSystem = nullptr;
+        thread_local size_t tCurrentWorker = 0;
+
+        // Memory of the worker running on the current thread, nullptr outside workers
+        thread_local scratch_arena *tJobScratch = nullptr;
+        thread_local scratch_arena *tFrameScratch = nullptr;
+        thread_local small_block_pool *tBlockPool = nullptr;
+
+        // Arena jobs running on the current thread, innermost first, jobs waiting on an arena
+        // run further jobs nested inside them
+        struct arena_frame
+        {
+            const task_arena *mArena;
+            const arena_frame *mOuter;
+        };
+        thread_local const arena_frame *tArenaFrames = nullptr;
+
+        // Jobs running on the current thread, more than one while a job waits on an arena
+        thread_local size_t tRunDepth = 0;
+
+        // job::mRankedQueue of jobs that are in no ranked heap
+        constexpr size_t kNotQueued = ~size_t(0);
+
+        // Timer wheel resolution
+        constexpr std::chrono::microseconds kTimerTick(100);
+        constexpr uint64_t kNoTimer = ~uint64_t(0);
+
+        // Idle rounds a worker yields for with wake_policy::spin before it sleeps, a few milliseconds
+        constexpr size_t kSpinIdleRounds = 4096;
+
+        // Pass advance of a weight 1 arena per job taken, heavier arenas advance proportionally less
+        constexpr uint64_t kArenaStride = uint64_t(1) << 20;
+
+        // Heap orderings also compare keys copied out of jobs that may have been run since
+        struct rank_less
+        {
+            using key_type = double;
+            static key_type key(const job *pJob) { return pJob->rank(); }
+
+            bool operator()(key_type pLeft, key_type pRight) const { return pLeft < pRight; }
+            bool operator()(const job *pLeft, const job *pRight) const
+            {
+                return key(pLeft) < key(pRight);
+            }
+        };
+
+        // Puts the earliest deadline on top of the heap
+        struct deadline_later
+        {
+            using key_type = std::chrono::high_resolution_clock::time_point;
+            static key_type key(const job *pJob) { return pJob->deadline(); }
+
+            bool operator()(key_type pLeft, key_type pRight) const { return pLeft > pRight; }
+            bool operator()(const job *pLeft, const job *pRight) const
+            {
+                return key(pLeft) > key(pRight);
+            }
+        };
+
+        /**
+         * @brief Raises an atomic value to at least pValue
+         * @return true if the value was raised
+         */
+        bool raise_to(std::atomic<double> &pTarget, double pValue)
+        {
+            double current = pTarget.load();
+            while (current < pValue)
+            {
+                if (pTarget.compare_exchange_weak(current, pValue))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        template <typename Compare>
+        job *pop_heap_top(std::vector<job *> &pHeap, Compare pCompare)
+        {
+            std::pop_heap(pHeap.begin(), pHeap.end(), pCompare);
+            job *top = pHeap.back();
+            pHeap.pop_back();
+            return top;
+        }
+
+        /**
+         * @brief Takes the most urgent job, according to pCompare, from all heaps except pThreadIndex's
+         * @param pQueued Number of jobs in all heaps, checked first so idle workers do not lock every queue
+         * @param pTaken Called with the stolen job while the victim's mutex is still held
+         */
+        template <typename Compare, typename Taken>
+        bool steal_heap_top(size_t pThreadIndex, std::vector<std::vector<job *>> &pHeaps,
+                            std::vector<std::mutex> &pMutexes, std::atomic<size_t> &pQueued,
+                            Compare pCompare, Taken pTaken, job* &pStolenJob)
+        {
+            if (pQueued.load(std::memory_order_relaxed) == 0)
+            {
+                return false;
+            }
+
+            // Find the thread holding the most urgent job, then try to take it. Only its key is
+            // kept, once unlocked the job may be run and deleted by its owner
+            size_t victim = pThreadIndex;
+            typename Compare::key_type best = typename Compare::key_type();
+            for (size_t i = 0; i < pHeaps.size(); ++i)
+            {
+                if (i == pThreadIndex)
+                    continue; // Skip own queue
+
+                std::unique_lock<std::mutex> lock(pMutexes[i]);
+                if (!pHeaps[i].empty() &&
+                    (victim == pThreadIndex || pCompare(best, Compare::key(pHeaps[i].front()))))
+                {
+                    victim = i;
+                    best = Compare::key(pHeaps[i].front());
+                }
+            }
+
+            if (victim == pThreadIndex)
+            {
+                return false;
+            }
+
+            // The victim may have popped in the meantime, then whatever is on top is taken
+            std::unique_lock<std::mutex> lock(pMutexes[victim]);
+            if (pHeaps[victim].empty())
+            {
+                return false;
+            }
+            pStolenJob = pop_heap_top(pHeaps[victim], pCompare);
+            pTaken(pStolenJob);
+            pQueued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    job_system::job_system(size_t pThreadCount, int /*pConfiguration*/)
         : 
         mNextThread(0),
         mThreads(),
         mThreadQueues(pThreadCount),
+        mRankedQueues(pThreadCount),
+        mDeadlineQueues(pThreadCount),
         mQueueMutexes(pThreadCount),
         mCondition(),
         mGlobalMutex(),
@@ -19,7 +166,9 @@ namespace cacau
         mJobSystemPaused(true),
         mTotalJobs(0),
         mCompletedJobs(0),
-        mJobsWaitingForDependencies(),
+        mLatencyShards(pThreadCount),
+        mWorkerMemory(pThreadCount),
+        mTimerEpoch(std::chrono::steady_clock::now()),
         mProfilingMutexes(pThreadCount),
         mThreadActiveTimes(pThreadCount),
         mThreadIdleTimes(pThreadCount)
@@ -37,8 +186,10 @@ namespace cacau
     job_system::~job_system()
     {
         {
+            // A paused job system still runs its queued jobs before the workers exit
             std::unique_lock<std::mutex> lock(mGlobalMutex);
             mStop = true;
+            mJobSystemPaused = false;
         }
         mCondition.notify_all();
 
@@ -49,19 +200,410 @@ namespace cacau
                 thread.join();
             }
         }
+
+        // Timers that never became due, periodic jobs are deleted with their timer
+        mTimers.clear([](timer_payload &pPayload)
+        {
+            delete pPayload.mJob;
+        });
+        mPeriodicTimers.clear();
     }
 
     void job_system::submit(job* pNewJob)
+    {
+        if (traits::kTracing && mLatencyTracking)
+        {
+            pNewJob->mTracing.get().mSubmitTime = std::chrono::high_resolution_clock::now();
+        }
+        assign_rank(pNewJob);
+        // Round-robin distribution, jobs may submit from several workers at once
+        size_t threadIndex = mNextThread.fetch_add(1, std::memory_order_relaxed) % mThreadQueues.size();
+        push_job(threadIndex, pNewJob);
+    }
+
+    void job_system::submit_to(size_t pThreadIndex, job* pNewJob)
+    {
+        if (traits::kTracing && mLatencyTracking)
+        {
+            pNewJob->mTracing.get().mSubmitTime = std::chrono::high_resolution_clock::now();
+        }
+        assign_rank(pNewJob);
+        push_job(pThreadIndex % mThreadQueues.size(), pNewJob);
+    }
+
+    void job_system::push_job(size_t pThreadIndex, job* pJob)
     {
         {
-            std::unique_lock<std::mutex> lock(mQueueMutexes[mNextThread]);
-            mThreadQueues[mNextThread].push_back(pNewJob);
+            std::unique_lock<std::mutex> lock(mQueueMutexes[pThreadIndex]);
+            scheduling_mode mode = traits::kPriorityQueues ? mSchedulingMode.load() : scheduling_mode::fifo;
+            if (traits::kPriorityQueues && mode == scheduling_mode::earliest_deadline &&
+                pJob->has_deadline() && !pJob->mPriority.get().mDeferred)
+            {
+                std::vector<job *> &heap = mDeadlineQueues.get()[pThreadIndex];
+                heap.push_back(pJob);
+                std::push_heap(heap.begin(), heap.end(), deadline_later());
+                mDeadlineJobs.fetch_add(1, std::memory_order_relaxed);
+            }
+            else if (traits::kPriorityQueues && mode == scheduling_mode::critical_path)
+            {
+                // Published before the rank is read, see raise_queued_rank
+                job::priority_state &priority = pJob->mPriority.get();
+                priority.mRankedQueue.store(pThreadIndex);
+                priority.mRank.store(priority.mEstimate + priority.mDownstreamRank.load(), std::memory_order_relaxed);
+                std::vector<job *> &heap = mRankedQueues.get()[pThreadIndex];
+                heap.push_back(pJob);
+                std::push_heap(heap.begin(), heap.end(), rank_less());
+                mRankedJobs.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                mThreadQueues[pThreadIndex].push_back(pJob);
+            }
             ++mTotalJobs;
         }
-        
+        wake_workers();
+    }
+
+    void job_system::wake_workers()
+    {
+        // Spinning workers only sleep after a while without work. Reading the counter after
+        // the job was counted pairs with the workers counting themselves before their check
+        if (traits::kWakePolicy == wake_policy::sleep || mSleepingWorkers.load() > 0)
+        {
+            // Synchronize with workers between their wake-up check and going to sleep
+            {
+                std::lock_guard<std::mutex> lock(mGlobalMutex);
+            }
+            mCondition.notify_all();
+        }
+    }
+
+    void job_system::enqueue_ready_job(job* pJob)
+    {
+        if (traits::kTracing && mLatencyTracking)
+        {
+            pJob->mTracing.get().mReadyTime = std::chrono::high_resolution_clock::now();
+        }
+
+        if (tCurrentJobSystem == this)
+        {
+            // Keep the dependant on the worker that just produced its inputs
+            push_job(tCurrentWorker, pJob);
+            return;
+        }
+
+        size_t threadIndex = mNextThread.fetch_add(1, std::memory_order_relaxed) % mThreadQueues.size();
+        push_job(threadIndex, pJob);
+    }
+
+    void job_system::register_arena(task_arena* pArena)
+    {
+        std::lock_guard<std::mutex> lock(mArenaMutex);
+        pArena->mPass = mArenaPass;
+        mArenas.push_back(pArena);
+    }
+
+    void job_system::unregister_arena(task_arena* pArena)
+    {
+        std::lock_guard<std::mutex> lock(mArenaMutex);
+        mArenas.erase(std::remove(mArenas.begin(), mArenas.end(), pArena), mArenas.end());
+    }
+
+    void job_system::push_arena_job(task_arena* pArena, job* pJob)
+    {
+        // Counted before it is queued, see wait_for_arena
+        pArena->mSubmittedJobs.fetch_add(1, std::memory_order_relaxed);
+
+        if (!traits::kTaskArenas)
+        {
+            // Runs like any other job, the wrapper only does the arena's bookkeeping
+            job *wrapper = new job([pArena, pJob]
+            {
+                arena_frame arenaFrame{pArena, tArenaFrames};
+                tArenaFrames = &arenaFrame;
+                pArena->mRunning.fetch_add(1, std::memory_order_relaxed);
+                pJob->execute();
+                pArena->mRunning.fetch_sub(1, std::memory_order_relaxed);
+                tArenaFrames = arenaFrame.mOuter;
+                delete pJob;
+
+                // Last, the arena may be destroyed as soon as its jobs count as completed
+                pArena->mCompletedJobs.fetch_add(1, std::memory_order_release);
+            }, pJob->name());
+            wrapper->set_type_id(pJob->type_id());
+            submit(wrapper);
+            return;
+        }
+
+        if (traits::kTracing && mLatencyTracking)
+        {
+            pJob->mTracing.get().mSubmitTime = std::chrono::high_resolution_clock::now();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mArenaMutex);
+            // An arena that had nothing queued starts from the current pass, instead of
+            // catching up on the turns it did not need
+            if (pArena->mQueue.empty())
+            {
+                pArena->mPass = std::max(pArena->mPass, mArenaPass);
+            }
+            pArena->mQueue.push_back(pJob);
+            ++mQueuedArenaJobs;
+            ++mTotalJobs;
+        }
+        wake_workers();
+    }
+
+    bool job_system::pop_arena_job(job* &pJob, task_arena* &pArena)
+    {
+        // Idle workers do not contend on the arena lock while no arena has queued jobs
+        if (mQueuedArenaJobs.load(std::memory_order_relaxed) == 0)
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mArenaMutex);
+        task_arena *next = nullptr;
+        for (task_arena *current : mArenas)
+        {
+            if (!current->mQueue.empty() && current->mRunning < current->mMaxConcurrency &&
+                (next == nullptr || current->mPass < next->mPass))
+            {
+                next = current;
+            }
+        }
+
+        if (next == nullptr)
+        {
+            return false;
+        }
+
+        pJob = next->mQueue.front();
+        next->mQueue.pop_front();
+        --mQueuedArenaJobs;
+        ++next->mRunning;
+        mArenaPass = next->mPass;
+        next->mPass += kArenaStride / next->mWeight;
+        pArena = next;
+        return true;
+    }
+
+    void job_system::wait_for_arena(task_arena* pArena)
+    {
+        resume();
+
+        // Jobs of this arena the calling thread is running cannot complete while it waits
+        uint64_t ownJobs = 0;
+        for (const arena_frame *frame = tArenaFrames; frame != nullptr; frame = frame->mOuter)
+        {
+            ownJobs += frame->mArena == pArena ? 1 : 0;
+        }
+
+        // Completed is read first: a job submitted in between makes the counts differ
+        bool onWorker = tCurrentJobSystem == this;
+        while (pArena->mCompletedJobs.load(std::memory_order_acquire) + ownJobs !=
+               pArena->mSubmittedJobs.load(std::memory_order_acquire))
+        {
+            job *nextJob = nullptr;
+            if (!traits::kTaskArenas)
+            {
+                // The arena's jobs are among the job system's, help with whichever comes next
+                if (onWorker && (pop_local_job(tCurrentWorker, nextJob) || steal_job(tCurrentWorker, nextJob)))
+                {
+                    if (!traits::kPriorityQueues || !handle_expired_job(tCurrentWorker, nextJob))
+                    {
+                        run_job(tCurrentWorker, nextJob, nullptr);
+                    }
+                    continue;
+                }
+            }
+            else if (onWorker && mQueuedArenaJobs.load(std::memory_order_relaxed) > 0)
+            {
+                // A job of this arena waiting on it lends its own slot
+                std::lock_guard<std::mutex> lock(mArenaMutex);
+                if (!pArena->mQueue.empty() && (ownJobs > 0 || pArena->mRunning < pArena->mMaxConcurrency))
+                {
+                    nextJob = pArena->mQueue.front();
+                    pArena->mQueue.pop_front();
+                    --mQueuedArenaJobs;
+                    ++pArena->mRunning;
+                }
+            }
+
+            if (nextJob != nullptr)
+            {
+                run_job(tCurrentWorker, nextJob, pArena);
+                continue;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    bool job_system::submit_after(std::chrono::nanoseconds pDelay, job* pNewJob)
+    {
+        if (pDelay.count() <= 0)
+        {
+            submit(pNewJob);
+            return true;
+        }
+        if (!traits::kTimers)
+        {
+            return false;
+        }
+
+        uint64_t expiry = timer_tick(std::chrono::steady_clock::now() + pDelay);
+        ++mPendingTimerJobs;
+        {
+            std::lock_guard<std::mutex> lock(mTimerMutex);
+            mTimers.schedule(expiry, timer_payload{pNewJob, nullptr});
+            update_timer_state();
+        }
+
+        // Sleeping workers recompute their timeout
+        {
+            std::lock_guard<std::mutex> lock(mGlobalMutex);
+        }
+        mCondition.notify_all();
+        return true;
+    }
+
+    uint64_t job_system::submit_periodic(std::chrono::nanoseconds pInterval, job* pJob)
+    {
+        if (!traits::kTimers)
+        {
+            return 0;
+        }
+
+        std::shared_ptr<periodic_timer> timer = std::make_shared<periodic_timer>();
+        timer->mJob = pJob;
+        auto tick = std::chrono::nanoseconds(kTimerTick).count();
+        timer->mIntervalTicks = pInterval.count() > tick ? static_cast<uint64_t>((pInterval.count() + tick - 1) / tick) : 1;
+
+        uint64_t expiry = timer_tick(std::chrono::steady_clock::now() + pInterval);
+        uint64_t timerId;
+        {
+            std::lock_guard<std::mutex> lock(mTimerMutex);
+            timerId = mNextTimerId++;
+            mPeriodicTimers[timerId] = timer;
+            mTimers.schedule(expiry, timer_payload{nullptr, timer});
+            update_timer_state();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mGlobalMutex);
+        }
         mCondition.notify_all();
+        return timerId;
+    }
+
+    bool job_system::cancel_periodic(uint64_t pTimerId)
+    {
+        std::lock_guard<std::mutex> lock(mTimerMutex);
+        auto found = mPeriodicTimers.find(pTimerId);
+        if (found == mPeriodicTimers.end())
+        {
+            return false;
+        }
+
+        // The wheel entry is dropped when it next expires
+        found->second->mCancelled = true;
+        mPeriodicTimers.erase(found);
+        return true;
+    }
+
+    uint64_t job_system::timer_tick(std::chrono::steady_clock::time_point pTime) const
+    {
+        if (pTime <= mTimerEpoch)
+        {
+            return 0;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(pTime - mTimerEpoch).count();
+        auto tick = std::chrono::duration_cast<std::chrono::nanoseconds>(kTimerTick).count();
+        return static_cast<uint64_t>((elapsed + tick - 1) / tick);
+    }
 
-        mNextThread = (mNextThread + 1) % mThreadQueues.size(); // Round-robin distribution
+    void job_system::update_timer_state()
+    {
+        uint64_t nextTick;
+        mNextTimerTick.store(mTimers.next_expiry(nextTick) ? nextTick : kNoTimer, std::memory_order_relaxed);
+        mTimerCount.store(mTimers.size(), std::memory_order_relaxed);
+    }
+
+    bool job_system::harvest_timers(size_t pThreadIndex)
+    {
+        if (mTimerCount.load(std::memory_order_relaxed) == 0)
+        {
+            return false;
+        }
+
+        // Round down, a timer is due once its whole tick has passed
+        auto elapsed = std::chrono::steady_clock::now() - mTimerEpoch;
+        uint64_t now = static_cast<uint64_t>(elapsed / kTimerTick);
+        if (now < mNextTimerTick.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        std::vector<job *> due;
+        size_t oneShots = 0;
+        {
+            std::unique_lock<std::mutex> lock(mTimerMutex, std::try_to_lock);
+            if (!lock.owns_lock())
+            {
+                return false;
+            }
+
+            std::vector<std::pair<uint64_t, std::shared_ptr<periodic_timer>>> rearmed;
+            mTimers.advance(now, [&](uint64_t pExpiry, timer_payload &pPayload)
+            {
+                if (pPayload.mPeriodic == nullptr)
+                {
+                    due.push_back(pPayload.mJob);
+                    ++oneShots;
+                    return;
+                }
+
+                std::shared_ptr<periodic_timer> &timer = pPayload.mPeriodic;
+                if (timer->mCancelled)
+                {
+                    return;
+                }
+
+                // A run still executing makes this one skip
+                if (!timer->mRunning.exchange(true))
+                {
+                    job *run = new job([timer]
+                    {
+                        timer->mJob->mFunction();
+                        timer->mRunning.store(false, std::memory_order_release);
+                    }, timer->mJob->name());
+                    run->set_type_id(timer->mJob->type_id());
+                    due.push_back(run);
+                }
+
+                // Fixed rate, intervals the workers fell behind on are skipped
+                uint64_t next = pExpiry + timer->mIntervalTicks;
+                if (next <= now)
+                {
+                    next += ((now - next) / timer->mIntervalTicks + 1) * timer->mIntervalTicks;
+                }
+                rearmed.emplace_back(next, timer);
+            });
+
+            for (auto &timer : rearmed)
+            {
+                mTimers.schedule(timer.first, timer_payload{nullptr, std::move(timer.second)});
+            }
+            update_timer_state();
+        }
+
+        // Counted as submitted before they stop counting as pending timers, see wait_for_all_jobs
+        for (job *dueJob : due)
+        {
+            submit_to(pThreadIndex, dueJob);
+        }
+        mPendingTimerJobs -= oneShots;
+        return !due.empty();
     }
 
     void job_system::submit_with_dependencies(job* pNewJob, const std::vector<job*> &pDependencies)
@@ -77,36 +619,270 @@ namespace cacau
         // Register job as waiting for dependencies
         LOG_MESSAGE("Submitting " + std::string(pNewJob->name()) +
                     " with " + std::to_string(pDependencies.size()) + " dependencies");
+        pNewJob->mDeleteOnCompletion = false;
+        if (traits::kTracing && mLatencyTracking)
         {
-            std::lock_guard<std::mutex> lock(mGlobalMutex);
-            mJobsWaitingForDependencies.push_back(pNewJob);
+            pNewJob->mTracing.get().mSubmitTime = std::chrono::high_resolution_clock::now();
         }
+        ++mWaitingJobs;
+        pNewJob->set_on_ready_callback([this, pNewJob]
+        {
+            enqueue_ready_job(pNewJob);
+            --mWaitingJobs;
+        });
+        assign_rank(pNewJob);
 
-        // Add dependencies and track if any are still pending
-        bool hasPendingDependencies = false;
+        // Hold an extra dependency while registering, so the job cannot become
+        // ready (and be queued) before every dependency has been added
+        pNewJob->add_dependency(nullptr);
         for (auto *dependency : pDependencies)
         {
-            if(dependency->add_dependant(pNewJob))
+            dependency->add_dependant(pNewJob);
+        }
+        if (traits::kPriorityQueues && mSchedulingMode == scheduling_mode::critical_path)
+        {
+            // Dependencies may already be queued, or be dependants of queued jobs
+            propagate_rank(pNewJob);
+        }
+
+        // If all dependencies are already satisfied this queues the job directly
+        pNewJob->resolve_dependency("submit_with_dependencies");
+    }
+
+    void job_system::assign_rank(job* pJob)
+    {
+        if (!traits::kPriorityQueues || mSchedulingMode != scheduling_mode::critical_path)
+        {
+            return;
+        }
+
+        // Not queued yet, so no heap orders by mRank
+        job::priority_state &priority = pJob->mPriority.get();
+        priority.mEstimate = get_estimated_execution_time(pJob->name());
+        priority.mRank.store(priority.mEstimate + priority.mDownstreamRank.load(std::memory_order_relaxed),
+                             std::memory_order_relaxed);
+    }
+
+    void job_system::propagate_rank(job* pJob)
+    {
+        job::priority_state &priority = pJob->mPriority.get();
+        double rank = priority.mEstimate + priority.mDownstreamRank.load();
+
+        // A dependency stays in the list, and alive, until it resolves pJob
+        std::lock_guard<std::mutex> lock(priority.mDependenciesMutex);
+        for (job *dependency : priority.mDependencies)
+        {
+            if (raise_to(dependency->mPriority.get().mDownstreamRank, rank))
             {
-                hasPendingDependencies = true;
+                raise_queued_rank(dependency);
+                propagate_rank(dependency);
             }
         }
+    }
 
-        // If all dependencies are already satisfied, submit the job directly
-        if (!hasPendingDependencies)
+    void job_system::raise_queued_rank(job* pJob)
+    {
+        // mDownstreamRank was raised before this read and push_job publishes the queue before it
+        // reads mDownstreamRank, so a job queued concurrently is either found here or ranked there
+        job::priority_state &priority = pJob->mPriority.get();
+        size_t queue = priority.mRankedQueue.load();
+        if (queue == kNotQueued)
         {
-            LOG_MESSAGE("Will execute " + std::string(pNewJob->name()) +
-                        " as all dependencies are already satisfied");
-            mJobsWaitingForDependencies.erase(
-                std::remove(mJobsWaitingForDependencies.begin(), 
-                           mJobsWaitingForDependencies.end(), pNewJob), 
-                mJobsWaitingForDependencies.end());
-            submit(pNewJob);
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mQueueMutexes[queue]);
+        double rank = priority.mEstimate + priority.mDownstreamRank.load();
+        if (priority.mRankedQueue.load(std::memory_order_relaxed) != queue || rank <= pJob->rank())
+        {
+            return;
+        }
+
+        // Increase-key: the heap up to the job is still a heap, sift it up from its position
+        std::vector<job *> &heap = mRankedQueues.get()[queue];
+        auto position = std::find(heap.begin(), heap.end(), pJob);
+        priority.mRank.store(rank, std::memory_order_relaxed);
+        std::push_heap(heap.begin(), position + 1, rank_less());
+    }
+
+    double job_system::get_estimated_execution_time(const char* pJobName)
+    {
+        return traits::kPriorityQueues ? mExecutionHistory.get().estimate(pJobName) : 1.0;
+    }
+
+    void job_system::record_execution_time(const char* pJobName, double pMicroseconds)
+    {
+        mExecutionHistory.get().record(pJobName, pMicroseconds);
+    }
+
+    void job_system::record_latency(size_t pThreadIndex, const job* pJob,
+                                    std::chrono::high_resolution_clock::time_point pStart,
+                                    std::chrono::high_resolution_clock::time_point pEnd)
+    {
+        using nanoseconds = std::chrono::nanoseconds;
+        using time_point = std::chrono::high_resolution_clock::time_point;
+
+        latency_key key = pJob->type_id() != 0
+            ? latency_key{nullptr, pJob->type_id()}
+            : latency_key{pJob->name(), 0};
+
+        latency_shard &shard = mLatencyShards.get()[pThreadIndex];
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        job_latency_stats &stats = shard.mStats[key];
+
+        // Jobs submitted before tracking was enabled have no timestamps
+        const job::tracing_state &tracing = pJob->mTracing.get();
+        if (tracing.mSubmitTime != time_point() && tracing.mSubmitTime <= pStart)
+        {
+            stats.queue_wait.record(std::chrono::duration_cast<nanoseconds>(pStart - tracing.mSubmitTime).count());
+        }
+        if (tracing.mReadyTime != time_point() && tracing.mReadyTime <= pStart)
+        {
+            stats.ready_wait.record(std::chrono::duration_cast<nanoseconds>(pStart - tracing.mReadyTime).count());
+        }
+        stats.run_time.record(std::chrono::duration_cast<nanoseconds>(pEnd - pStart).count());
+    }
+
+    job_latency_stats job_system::collect_latency_stats(const latency_key &pKey)
+    {
+        job_latency_stats merged;
+        if (!traits::kTracing)
+        {
+            return merged;
+        }
+
+        for (auto &shard : mLatencyShards.get())
+        {
+            std::lock_guard<std::mutex> lock(shard.mMutex);
+            auto entry = shard.mStats.find(pKey);
+            if (entry != shard.mStats.end())
+            {
+                merged.queue_wait.merge(entry->second.queue_wait);
+                merged.ready_wait.merge(entry->second.ready_wait);
+                merged.run_time.merge(entry->second.run_time);
+            }
+        }
+        return merged;
+    }
+
+    job_latency_stats job_system::get_latency_stats(const char* pJobName)
+    {
+        return collect_latency_stats(latency_key{pJobName, 0});
+    }
+
+    job_latency_stats job_system::get_type_latency_stats(uint32_t pTypeId)
+    {
+        return collect_latency_stats(latency_key{nullptr, pTypeId});
+    }
+
+    void job_system::reset_latency_stats()
+    {
+        if (!traits::kTracing)
+        {
+            return;
+        }
+
+        for (auto &shard : mLatencyShards.get())
+        {
+            std::lock_guard<std::mutex> lock(shard.mMutex);
+            shard.mStats.clear();
+        }
+    }
+
+    void job_system::print_latency_stats()
+    {
+        if (!traits::kTracing)
+        {
+            std::cout << "Latency tracking is compiled out (CACAU_JOBS_TRACING is 0)\n";
+            return;
+        }
+
+        // Gather the keys first, so each shard is only locked briefly
+        std::vector<latency_key> keys;
+        for (auto &shard : mLatencyShards.get())
+        {
+            std::lock_guard<std::mutex> lock(shard.mMutex);
+            for (const auto &entry : shard.mStats)
+            {
+                if (std::find(keys.begin(), keys.end(), entry.first) == keys.end())
+                {
+                    keys.push_back(entry.first);
+                }
+            }
+        }
+
+        auto print_histogram = [](const char* pLabel, const latency_histogram &pHistogram)
+        {
+            std::cout << "  " << pLabel << ": "
+                      << "count " << pHistogram.count() << ", "
+                      << "p50 " << pHistogram.percentile(50.0) / 1000.0 << " us, "
+                      << "p99 " << pHistogram.percentile(99.0) / 1000.0 << " us, "
+                      << "p999 " << pHistogram.percentile(99.9) / 1000.0 << " us, "
+                      << "max " << pHistogram.max() / 1000.0 << " us\n";
+        };
+
+        for (const auto &key : keys)
+        {
+            job_latency_stats stats = collect_latency_stats(key);
+            if (key.mName != nullptr)
+            {
+                std::cout << "Job " << key.mName << ":\n";
+            }
+            else
+            {
+                std::cout << "Job type " << key.mTypeId << ":\n";
+            }
+            print_histogram("Queue wait", stats.queue_wait);
+            if (stats.ready_wait.count() > 0)
+            {
+                print_histogram("Ready wait", stats.ready_wait);
+            }
+            print_histogram("Run time", stats.run_time);
         }
     }
 
+    bool job_system::pop_local_job(size_t pThreadIndex, job* &pJob)
+    {
+        std::unique_lock<std::mutex> lock(mQueueMutexes[pThreadIndex]);
+        if (traits::kPriorityQueues)
+        {
+            std::vector<job *> &deadlineHeap = mDeadlineQueues.get()[pThreadIndex];
+            if (!deadlineHeap.empty())
+            {
+                pJob = pop_heap_top(deadlineHeap, deadline_later());
+                mDeadlineJobs.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            std::vector<job *> &rankedHeap = mRankedQueues.get()[pThreadIndex];
+            if (!rankedHeap.empty())
+            {
+                pJob = pop_heap_top(rankedHeap, rank_less());
+                pJob->mPriority.get().mRankedQueue.store(kNotQueued, std::memory_order_relaxed);
+                mRankedJobs.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        if (!mThreadQueues[pThreadIndex].empty())
+        {
+            pJob = mThreadQueues[pThreadIndex].front();
+            mThreadQueues[pThreadIndex].pop_front();
+            return true;
+        }
+        return false;
+    }
+
     bool job_system::steal_job(size_t pThreadIndex, job* &pStolenJob)
     {
+        // Prefer the most urgent remote work, jobs queued under another mode are still stolen below.
+        // The heap passes return without locking while no heap holds a job, as in fifo mode
+        if (traits::kPriorityQueues &&
+            (steal_deadline_job(pThreadIndex, pStolenJob) || steal_ranked_job(pThreadIndex, pStolenJob)))
+        {
+            return true;
+        }
+
         // Try to steal from other threads' queues
         for (size_t i = 0; i < mThreadQueues.size(); ++i)
         {
@@ -125,53 +901,209 @@ namespace cacau
         return false;
     }
 
+    bool job_system::steal_ranked_job(size_t pThreadIndex, job* &pStolenJob)
+    {
+        return steal_heap_top(pThreadIndex, mRankedQueues.get(), mQueueMutexes, mRankedJobs, rank_less(),
+                              [](job *pJob) { pJob->mPriority.get().mRankedQueue.store(kNotQueued, std::memory_order_relaxed); },
+                              pStolenJob);
+    }
+
+    bool job_system::steal_deadline_job(size_t pThreadIndex, job* &pStolenJob)
+    {
+        return steal_heap_top(pThreadIndex, mDeadlineQueues.get(), mQueueMutexes, mDeadlineJobs, deadline_later(),
+                              [](job *) {}, pStolenJob);
+    }
+
+    bool job_system::handle_expired_job(size_t pThreadIndex, job* pJob)
+    {
+        if (!pJob->has_deadline() || pJob->mPriority.get().mDeferred)
+        {
+            return false;
+        }
+
+        deadline_miss_policy policy = mDeadlineMissPolicy;
+        if (policy == deadline_miss_policy::run ||
+            std::chrono::high_resolution_clock::now() <= pJob->deadline())
+        {
+            return false;
+        }
+
+        if (policy == deadline_miss_policy::drop)
+        {
+            LOG_MESSAGE("Dropping " + std::string(pJob->name()) + " after its deadline");
+            ++mDeadlinesDropped;
+            pJob->skip();
+
+            if (pJob->mDeleteOnCompletion)
+            {
+                ++mCompletedJobs;
+                delete pJob;
+            }
+            else
+            {
+                pJob->mCompleted.store(true, std::memory_order_release);
+                ++mCompletedJobs;
+            }
+            return true;
+        }
+
+        // Defer: queue behind the jobs without a deadline, it is already counted in mTotalJobs
+        LOG_MESSAGE("Deferring " + std::string(pJob->name()) + " after its deadline");
+        ++mDeadlinesDeferred;
+        pJob->mPriority.get().mDeferred = true;
+        {
+            std::unique_lock<std::mutex> lock(mQueueMutexes[pThreadIndex]);
+            mThreadQueues[pThreadIndex].push_back(pJob);
+        }
+        return true;
+    }
+
+    void job_system::record_deadline(const job* pJob, std::chrono::high_resolution_clock::time_point pEnd)
+    {
+        if (!pJob->has_deadline())
+        {
+            return;
+        }
+
+        if (pEnd <= pJob->deadline())
+        {
+            ++mDeadlinesMet;
+        }
+        else
+        {
+            ++mDeadlinesMissed;
+        }
+    }
+
+    deadline_stats job_system::get_deadline_stats() const
+    {
+        deadline_stats stats;
+        stats.met = mDeadlinesMet.load();
+        stats.missed = mDeadlinesMissed.load();
+        stats.dropped = mDeadlinesDropped.load();
+        stats.deferred = mDeadlinesDeferred.load();
+        return stats;
+    }
+
+    void job_system::reset_deadline_stats()
+    {
+        mDeadlinesMet = 0;
+        mDeadlinesMissed = 0;
+        mDeadlinesDropped = 0;
+        mDeadlinesDeferred = 0;
+    }
+
     void job_system::worker_thread(size_t pThreadIndex)
     {
-        //auto thread_start = std::chrono::high_resolution_clock::now();
+        using clock = std::chrono::high_resolution_clock;
+
+        tCurrentJobSystem = this;
+        tCurrentWorker = pThreadIndex;
+
+        worker_memory &memory = mWorkerMemory[pThreadIndex];
+        if (traits::kWorkerScratch)
+        {
+            tJobScratch = &memory.mScratch.get().mJobScratch;
+            tFrameScratch = &memory.mScratch.get().mFrameScratch;
+        }
+        tBlockPool = &memory.mBlocks;
 
+        size_t arenaTurn = 0;
+        size_t idleRounds = 0;
         while (true)
         {
-            // Check if system is paused
+            // Check if system is paused, resume() and the destructor wake the workers up
             if (mJobSystemPaused)
             {
-                std::this_thread::yield();
+                if (traits::kWakePolicy == wake_policy::spin && ++idleRounds < kSpinIdleRounds)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(mGlobalMutex);
+                ++mSleepingWorkers;
+                mCondition.wait(lock, [this] { return mStop || !mJobSystemPaused; });
+                --mSleepingWorkers;
+                idleRounds = 0;
                 continue;
             }
 
             job *my_job = nullptr;
-            auto idle_start = std::chrono::high_resolution_clock::now();
+            task_arena *arena = nullptr;
+            clock::time_point idle_start;
+            if (traits::kProfiling)
+            {
+                idle_start = clock::now();
+            }
+
+            // Task arenas and the job system's own queues take turns, so neither starves the other
+            bool arenasFirst = traits::kTaskArenas && mQueuedArenaJobs.load(std::memory_order_relaxed) > 0 &&
+                               (++arenaTurn & 1) != 0;
+            if (arenasFirst)
+            {
+                pop_arena_job(my_job, arena);
+            }
 
             // Try to get job from local queue
+            if (!my_job)
             {
-                std::unique_lock<std::mutex> lock(mQueueMutexes[pThreadIndex]);
-                if (!mThreadQueues[pThreadIndex].empty())
-                {
-                    my_job = mThreadQueues[pThreadIndex].front();
-                    mThreadQueues[pThreadIndex].pop_front();
-                }
+                pop_local_job(pThreadIndex, my_job);
             }
 
-            // If no local job, try to steal one
-            if (!my_job && !steal_job(pThreadIndex, my_job))
+            // If no local job, try to steal one, then try the arenas
+            if (!my_job && !steal_job(pThreadIndex, my_job) &&
+                (!traits::kTaskArenas || arenasFirst || !pop_arena_job(my_job, arena)))
             {
-                // Update idle time statistics
-                auto idle_end = std::chrono::high_resolution_clock::now();
-                double idle_time = std::chrono::duration<double, std::milli>(
-                    idle_end - idle_start).count();
-                double current_idle_time = mThreadIdleTimes[pThreadIndex].load(
-                    std::memory_order_relaxed);
-                
+                if (traits::kProfiling)
                 {
-                    std::lock_guard<std::mutex> lock(mProfilingMutexes[pThreadIndex]);
-                    mThreadIdleTimes[pThreadIndex].store(
-                        current_idle_time + idle_time, std::memory_order_relaxed);
+                    // Update idle time statistics
+                    auto idle_end = clock::now();
+                    double idle_time = std::chrono::duration<double, std::milli>(
+                        idle_end - idle_start).count();
+                    double current_idle_time = mThreadIdleTimes[pThreadIndex].load(
+                        std::memory_order_relaxed);
+
+                    {
+                        std::lock_guard<std::mutex> lock(mProfilingMutexes[pThreadIndex]);
+                        mThreadIdleTimes[pThreadIndex].store(
+                            current_idle_time + idle_time, std::memory_order_relaxed);
+                    }
                 }
 
-                // Wait for new work or shutdown signal
-                std::unique_lock<std::mutex> lock(mGlobalMutex);
-                mCondition.wait(lock, [this] {
-                    return mStop || (!mJobSystemPaused && mTotalJobs > mCompletedJobs);
-                });
+                // Due timers are dispatched before going to sleep
+                if (traits::kTimers && harvest_timers(pThreadIndex))
+                {
+                    continue;
+                }
+
+                // Spinning workers yield for a bounded time, then sleep like the others
+                if (traits::kWakePolicy == wake_policy::sleep || ++idleRounds >= kSpinIdleRounds)
+                {
+                    // Wait for new work, the next due timer or shutdown signal
+                    // A timer scheduled earlier than the one slept for changes the timeout
+                    std::unique_lock<std::mutex> lock(mGlobalMutex);
+                    ++mSleepingWorkers;
+                    uint64_t nextTimer = mNextTimerTick.load(std::memory_order_relaxed);
+                    auto wakeUp = [this, nextTimer] {
+                        return mStop || (!mJobSystemPaused && mTotalJobs > mCompletedJobs) ||
+                               mNextTimerTick.load(std::memory_order_relaxed) != nextTimer;
+                    };
+                    if (nextTimer != kNoTimer)
+                    {
+                        auto due = mTimerEpoch + std::chrono::duration_cast<std::chrono::steady_clock::duration>(kTimerTick * nextTimer);
+                        mCondition.wait_until(lock, due, wakeUp);
+                    }
+                    else
+                    {
+                        mCondition.wait(lock, wakeUp);
+                    }
+                    --mSleepingWorkers;
+                    idleRounds = 0;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
 
                 // Check if should exit
                 if (mStop && mTotalJobs == mCompletedJobs)
@@ -184,29 +1116,168 @@ namespace cacau
             // Execute the job if we got one
             if (my_job)
             {
-                // Track execution time for profiling
-                auto start_time = std::chrono::high_resolution_clock::now();
-                my_job->execute();
-                auto end_time = std::chrono::high_resolution_clock::now();
-
-                // Update active time statistics
-                double execution_time = std::chrono::duration<double, std::milli>(
-                    end_time - start_time).count();
-                double currentActiveTime = mThreadActiveTimes[pThreadIndex].load(
-                    std::memory_order_relaxed);
-                
+                idleRounds = 0;
+
+                // Jobs picked up after their deadline may be dropped or pushed back, arena jobs always run
+                if (traits::kPriorityQueues && arena == nullptr && handle_expired_job(pThreadIndex, my_job))
                 {
-                    std::lock_guard<std::mutex> lock(mProfilingMutexes[pThreadIndex]);
-                    mThreadActiveTimes[pThreadIndex].store(
-                        currentActiveTime + execution_time, std::memory_order_relaxed);
+                    continue;
                 }
 
-                ++mCompletedJobs;
-                delete my_job;
+                run_job(pThreadIndex, my_job, arena);
+
+                // Busy workers dispatch overdue timers too
+                if (traits::kTimers)
+                {
+                    harvest_timers(pThreadIndex);
+                }
             }
         }
     }
 
+    void job_system::run_job(size_t pThreadIndex, job* pJob, task_arena* pArena)
+    {
+        using clock = std::chrono::high_resolution_clock;
+
+        // Jobs are only timed when a compiled-in feature consumes the timestamps
+        constexpr bool kTimedExecution = traits::kProfiling || traits::kTracing || traits::kPriorityQueues;
+
+        // Free the previous frame's allocations once a new frame started. Jobs run while
+        // waiting inside another job leave them to the outer job, which may still use them
+        scratch_arena::marker_type scratchStart = scratch_arena::marker_type();
+        if (traits::kWorkerScratch)
+        {
+            worker_scratch &memory = mWorkerMemory[pThreadIndex].mScratch.get();
+            uint64_t frame = mFrameIndex.load(std::memory_order_relaxed);
+            if (tRunDepth == 0 && memory.mFrame != frame)
+            {
+                memory.mFrameScratch.reset();
+                memory.mFrame = frame;
+            }
+
+            // Jobs run while waiting inside another job keep the outer job's scratch allocations
+            scratchStart = memory.mJobScratch.marker();
+        }
+
+        // Track execution time for profiling
+        clock::time_point start_time;
+        clock::time_point end_time;
+        if (kTimedExecution)
+        {
+            start_time = clock::now();
+        }
+        arena_frame arenaFrame{pArena, tArenaFrames};
+        if (traits::kTaskArenas && pArena != nullptr)
+        {
+            tArenaFrames = &arenaFrame;
+        }
+        if (traits::kWorkerScratch)
+        {
+            ++tRunDepth;
+        }
+        pJob->execute();
+        if (traits::kWorkerScratch)
+        {
+            --tRunDepth;
+        }
+        if (traits::kTaskArenas)
+        {
+            tArenaFrames = arenaFrame.mOuter;
+        }
+        if (kTimedExecution)
+        {
+            end_time = clock::now();
+        }
+        if (traits::kWorkerScratch)
+        {
+            mWorkerMemory[pThreadIndex].mScratch.get().mJobScratch.rewind(scratchStart);
+        }
+        double execution_time = std::chrono::duration<double, std::milli>(
+            end_time - start_time).count();
+
+        if (traits::kProfiling)
+        {
+            // Update active time statistics
+            double currentActiveTime = mThreadActiveTimes[pThreadIndex].load(
+                std::memory_order_relaxed);
+
+            {
+                std::lock_guard<std::mutex> lock(mProfilingMutexes[pThreadIndex]);
+                mThreadActiveTimes[pThreadIndex].store(
+                    currentActiveTime + execution_time, std::memory_order_relaxed);
+            }
+        }
+
+        if (traits::kPriorityQueues && mSchedulingMode == scheduling_mode::critical_path)
+        {
+            record_execution_time(pJob->name(), execution_time * 1000.0);
+        }
+        if (traits::kTracing && mLatencyTracking)
+        {
+            record_latency(pThreadIndex, pJob, start_time, end_time);
+        }
+        if (traits::kPriorityQueues)
+        {
+            // Counted with the same trait as the miss policies, so drops are never reported alone
+            record_deadline(pJob, end_time);
+        }
+
+        // The job may be deleted by its owner as soon as it counts as completed
+        bool deleteJob = pJob->mDeleteOnCompletion;
+        if (traits::kTaskArenas && pArena != nullptr)
+        {
+            // Only read under the arena lock when picking a job, a stale value just delays the next one
+            pArena->mRunning.fetch_sub(1, std::memory_order_relaxed);
+        }
+        if (deleteJob)
+        {
+            ++mCompletedJobs;
+            delete pJob;
+        }
+        else
+        {
+            // Not touched again: from here wait() and wait_for_all_jobs() return and the owner may delete it
+            pJob->mCompleted.store(true, std::memory_order_release);
+            ++mCompletedJobs;
+        }
+
+        // Last, the arena may be destroyed as soon as its jobs count as completed
+        if (traits::kTaskArenas && pArena != nullptr)
+        {
+            pArena->mCompletedJobs.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    scratch_arena &job_system::scratch()
+    {
+        if (tJobScratch != nullptr)
+        {
+            return *tJobScratch;
+        }
+        static thread_local scratch_arena threadScratch;
+        return threadScratch;
+    }
+
+    scratch_arena &job_system::frame_scratch()
+    {
+        if (tFrameScratch != nullptr)
+        {
+            return *tFrameScratch;
+        }
+        static thread_local scratch_arena threadFrameScratch;
+        return threadFrameScratch;
+    }
+
+    void* job_system::allocate_block(size_t pSize)
+    {
+        return small_block_pool::allocate(tBlockPool, pSize);
+    }
+
+    void job_system::deallocate_block(void* pBlock)
+    {
+        small_block_pool::deallocate(tBlockPool, pBlock);
+    }
+
     size_t job_system::get_pending_jobs()
     {
         size_t pending_jobs = 0;
@@ -217,28 +1288,51 @@ namespace cacau
             {
                 std::unique_lock<std::mutex> lock(mQueueMutexes[i]);                
                 pending_jobs += mThreadQueues[i].size();
+                if (traits::kPriorityQueues)
+                {
+                    pending_jobs += mRankedQueues.get()[i].size() + mDeadlineQueues.get()[i].size();
+                }
             }
         }
 
-        // Add jobs waiting for dependencies
+        // Count jobs queued in task arenas, they are in the thread queues without arena queues
+        if (traits::kTaskArenas)
         {
-            std::lock_guard<std::mutex> lock(mGlobalMutex); // Protect access to jobs with dependencies
-            for (const auto &job : mJobsWaitingForDependencies)
+            std::lock_guard<std::mutex> lock(mArenaMutex);
+            for (const task_arena *arena : mArenas)
             {
-                if (job != nullptr && !job->is_ready())
-                {
-                    ++pending_jobs;
-                }
+                pending_jobs += arena->mQueue.size();
             }
         }
 
+        // Add jobs waiting for dependencies
+        pending_jobs += mWaitingJobs.load();
+
         return pending_jobs;
     }
 
+    void job_system::resume()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mGlobalMutex);
+            mJobSystemPaused = false;
+        }
+        mCondition.notify_all();
+    }
+
     void job_system::wait_for_all_jobs() {
         resume();
 
-        while (get_pending_jobs() > 0) {
+        // Running jobs are not pending, so also wait until every queued job has completed.
+        // Completed is read first: queued dependants are counted before their parent completes.
+        // Pending one-shot timers are read before both: harvested jobs are counted as submitted
+        // before they stop counting as pending timers
+        while (true) {
+            size_t pendingTimers = mPendingTimerJobs.load();
+            size_t completed = mCompletedJobs.load();
+            if (pendingTimers == 0 && completed == mTotalJobs.load() && get_pending_jobs() == 0) {
+                break;
+            }
             std::this_thread::yield(); // Allow worker threads to run
         }
     }
@@ -252,7 +1346,7 @@ namespace cacau
         }
 
         resume();
-        while (pJobToWait != nullptr && !pJobToWait->is_finished())
+        while (!pJobToWait->mCompleted.load(std::memory_order_acquire))
         {
             std::this_thread::yield();
         }
@@ -267,6 +1361,12 @@ namespace cacau
 
     void job_system::print_thread_utilization() const
     {
+        if (!traits::kProfiling)
+        {
+            std::cout << "Thread utilization is compiled out (CACAU_JOBS_PROFILING is 0)\n";
+            return;
+        }
+
         for (size_t i = 0; i < mThreads.size(); ++i) {
             double total_time = mThreadActiveTimes[i].load() + mThreadIdleTimes[i].load();
             double active_percentage = (total_time > 0) ? 
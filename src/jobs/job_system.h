@@ -1,18 +1,67 @@
 #pragma once
 #include <deque>
+#include <memory>
 #include <vector>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
 #include <chrono>
+#include <unordered_map>
+#include "execution_history.h"
 #include "job.h"
+#include "latency_histogram.h"
+#include "scratch_arena.h"
+#include "small_block_pool.h"
+#include "task_arena.h"
+#include "timer_wheel.h"
 
 namespace cacau
 {
     namespace jobs
     {
 
+        /**
+         * @brief Order in which ready jobs are picked from the worker queues
+         */
+        enum class scheduling_mode
+        {
+            fifo,          ///< Jobs run in the order they became ready (default)
+            critical_path,    ///< Jobs with the longest estimated remaining dependency chain run first
+            earliest_deadline ///< Jobs with a deadline run earliest-deadline-first, before jobs without one
+        };
+
+        /**
+         * @brief What happens to a job whose deadline already passed when a worker picks it up
+         */
+        enum class deadline_miss_policy
+        {
+            run,   ///< Run it anyway (default)
+            drop,  ///< Skip its function, dependants are still released
+            defer  ///< Move it behind the jobs without a deadline, once
+        };
+
+        /**
+         * @brief Deadline counters since creation or the last reset
+         */
+        struct deadline_stats
+        {
+            uint64_t met = 0;      ///< Finished before their deadline
+            uint64_t missed = 0;   ///< Finished after their deadline
+            uint64_t dropped = 0;  ///< Skipped by deadline_miss_policy::drop
+            uint64_t deferred = 0; ///< Moved back by deadline_miss_policy::defer
+        };
+
+        /**
+         * @brief Latency histograms of one job name or type id
+         */
+        struct job_latency_stats
+        {
+            latency_histogram queue_wait; ///< From submit to start of execution
+            latency_histogram ready_wait; ///< From last dependency resolved to start, dependent jobs only
+            latency_histogram run_time;   ///< Execution time
+        };
+
         /**
          * @brief Multi-threaded job system that manages job execution and dependencies
          * @details Provides work stealing, dependency tracking, and performance monitoring
@@ -25,7 +74,7 @@ namespace cacau
              * @brief Initializes the job system with a specified number of worker threads
              * @param thread_count Number of worker threads to create in the thread pool
              */
-            explicit job_system(size_t pThreadCount);
+            explicit job_system(size_t pThreadCount) : job_system(pThreadCount, CACAU_JOBS_CONFIGURATION) {}
             ~job_system();
 
             /**
@@ -35,21 +84,71 @@ namespace cacau
              */
             void submit(job* pNewJob);
 
+            /**
+             * @brief Submits a job to a specific worker's queue
+             * @param pThreadIndex Worker index, wrapped around the thread count
+             * @param pNewJob The job to be executed
+             * @details Keeps related work on the same worker (and its cache) across frames,
+             *          idle workers may still steal it
+             */
+            void submit_to(size_t pThreadIndex, job* pNewJob);
+
+            /**
+             * @brief Gets the number of worker threads
+             */
+            size_t thread_count() const { return mThreadQueues.size(); }
+
             /**
              * @brief Submits a job that depends on other jobs
              * @param new_job The job to be executed
              * @param dependencies List of jobs that must complete before this one starts
+             * @details Once ready the job is queued on the worker that resolved its last dependency.
+             *          Jobs submitted with dependencies are not deleted by the job system, so they
+             *          can still be passed to wait() after they finish
              */
             void submit_with_dependencies(job* pNewJob, const std::vector<job*> &pDependencies);
 
+            /**
+             * @brief Submits a job to run once pDelay has elapsed
+             * @details Timers have a resolution of 100 microseconds. Due timers are harvested by
+             *          workers that run out of jobs, before they go to sleep, and sleeping workers
+             *          wake up for the next due timer, so no timer thread is needed. The job counts
+             *          for wait_for_all_jobs() from now on and is deleted after it runs
+             * @return false if CACAU_JOBS_TIMERS is 0 and pDelay is positive, the job is then
+             *         not submitted and still belongs to the caller
+             */
+            bool submit_after(std::chrono::nanoseconds pDelay, job* pNewJob);
+
+            /**
+             * @brief Runs a job every pInterval, the first time one interval from now
+             * @details Runs are scheduled at a fixed rate. A run is skipped if the previous one
+             *          is still executing or if the workers fell a whole interval behind. The job
+             *          system owns the job and deletes it once the timer is cancelled or the system
+             *          is destroyed. Periodic runs are not waited for by wait_for_all_jobs()
+             * @return Id to pass to cancel_periodic(), 0 if CACAU_JOBS_TIMERS is 0: the job is then
+             *         not scheduled and still belongs to the caller
+             */
+            uint64_t submit_periodic(std::chrono::nanoseconds pInterval, job* pJob);
+
+            /**
+             * @brief Stops a periodic job, a run already dispatched still completes
+             * @return false if no periodic job has this id
+             */
+            bool cancel_periodic(uint64_t pTimerId);
+
+            /**
+             * @brief Gets the number of timers waiting in the timer wheel, one-shot and periodic
+             */
+            size_t get_pending_timers() const { return mTimerCount.load(std::memory_order_relaxed); }
+
             /**
              * @brief Gets the number of jobs waiting to be executed
-             * @return Total number of pending jobs across all queues
+             * @return Total number of pending jobs across all queues, task arenas included
              */
             size_t get_pending_jobs();
 
             /**
-             * @brief Blocks until all submitted jobs are completed
+             * @brief Blocks until all submitted jobs are completed, the jobs of task arenas included
              */
             void wait_for_all_jobs();
 
@@ -59,19 +158,178 @@ namespace cacau
             void pause() { mJobSystemPaused = true; }
 
             /**
-             * @brief Resumes job execution
+             * @brief Resumes job execution and wakes up sleeping workers
              */
-            void resume() { mJobSystemPaused = false; }
+            void resume();
 
+            /**
+             * @brief Blocks until a job submitted with dependencies has completed
+             * @details Returns once the workers no longer touch the job, so the caller may delete it
+             */
             void wait(job* pJobToWait);
 
+            /**
+             * @brief Selects how ready jobs are ordered in the worker queues
+             * @details In critical_path mode every job is ranked by its estimated remaining
+             *          critical-path length: its own historical execution time plus the highest
+             *          rank among its dependants. Workers pop and steal the highest ranked job first.
+             *          Dependants may be submitted before or after the jobs they depend on, the
+             *          rank of queued dependencies is raised when dependants are registered.
+             * @return false if the mode is compiled out, only fifo is available when
+             *         CACAU_JOBS_PRIORITY_QUEUES is 0 and the mode is left unchanged
+             */
+            bool set_scheduling_mode(scheduling_mode pMode)
+            {
+                if (!job_system_traits::kPriorityQueues && pMode != scheduling_mode::fifo)
+                {
+                    return false;
+                }
+                mSchedulingMode = pMode;
+                return true;
+            }
+            scheduling_mode get_scheduling_mode() const { return mSchedulingMode; }
+
+            /**
+             * @brief Selects what happens to jobs picked up after their deadline
+             * @return false if the policy is compiled out, only run is available when
+             *         CACAU_JOBS_PRIORITY_QUEUES is 0 and the policy is left unchanged
+             */
+            bool set_deadline_miss_policy(deadline_miss_policy pPolicy)
+            {
+                if (!job_system_traits::kPriorityQueues && pPolicy != deadline_miss_policy::run)
+                {
+                    return false;
+                }
+                mDeadlineMissPolicy = pPolicy;
+                return true;
+            }
+            deadline_miss_policy get_deadline_miss_policy() const { return mDeadlineMissPolicy; }
+
+            /**
+             * @brief Gets the deadline met/missed/dropped/deferred counters
+             * @details Counted for every job with a deadline, in every scheduling mode.
+             *          Always zero when CACAU_JOBS_PRIORITY_QUEUES is 0
+             */
+            deadline_stats get_deadline_stats() const;
+
+            /**
+             * @brief Resets the deadline counters to zero
+             */
+            void reset_deadline_stats();
+
+            /**
+             * @brief Gets the historical execution time for jobs with the given name
+             * @param pJobName Job name, compared by pointer (names are expected to be string literals)
+             * @return Moving average in microseconds, or the average of all jobs for unknown names
+             * @details History is only collected in critical_path scheduling mode. Reading and
+             *          recording take no lock, see execution_history. Always 1 when
+             *          CACAU_JOBS_PRIORITY_QUEUES is 0
+             */
+            double get_estimated_execution_time(const char* pJobName);
+
+            /**
+             * @brief Enables per-job-type latency histograms
+             * @details Disabled by default. Samples are recorded into per-worker shards
+             *          and merged when queried. Jobs are grouped by type id when set, by name otherwise.
+             * @return false if enabling was requested but CACAU_JOBS_TRACING is 0, tracking then stays off
+             */
+            bool set_latency_tracking(bool pEnabled)
+            {
+                if (!job_system_traits::kTracing && pEnabled)
+                {
+                    return false;
+                }
+                mLatencyTracking = pEnabled;
+                return true;
+            }
+            bool is_latency_tracking() const { return mLatencyTracking; }
+
+            /**
+             * @brief Gets the merged latency histograms of jobs with the given name
+             * @param pJobName Job name, compared by pointer (names are expected to be string literals)
+             * @return Empty histograms when CACAU_JOBS_TRACING is 0
+             */
+            job_latency_stats get_latency_stats(const char* pJobName);
+
+            /**
+             * @brief Gets the merged latency histograms of jobs with the given type id
+             * @param pTypeId Type id set with job::set_type_id
+             * @return Empty histograms when CACAU_JOBS_TRACING is 0
+             */
+            job_latency_stats get_type_latency_stats(uint32_t pTypeId);
+
+            /**
+             * @brief Clears all recorded latency samples
+             */
+            void reset_latency_stats();
+
+            /**
+             * @brief Prints p50/p99/p999 queue wait, ready wait and run time for every job type
+             */
+            void print_latency_stats();
+
+            /**
+             * @brief Gets the calling worker's scratch arena for temporary allocations of the running job
+             * @details Everything allocated from it is freed when the job returns, so pointers
+             *          must not escape the job. Called outside a worker, or on any thread when
+             *          CACAU_JOBS_WORKER_SCRATCH is 0, returns an arena owned by the calling thread
+             *          that is only freed by calling reset() on it
+             */
+            static scratch_arena &scratch();
+
+            /**
+             * @brief Gets the calling worker's per-frame arena
+             * @details Allocations stay valid until the next begin_frame() of the job system
+             *          that owns the worker, so jobs of the same frame can hand data to each
+             *          other. Called outside a worker, or on any thread when CACAU_JOBS_WORKER_SCRATCH
+             *          is 0, returns an arena owned by the calling thread that is only freed by
+             *          calling reset() on it
+             */
+            static scratch_arena &frame_scratch();
+
+            /**
+             * @brief Starts a new frame, freeing every worker's frame_scratch()
+             * @details Call between frames, once no job still uses the previous frame's allocations.
+             *          Workers free their frame arena lazily, before running their next job that is
+             *          not run inside another job's wait
+             */
+            void begin_frame() { mFrameIndex.fetch_add(1, std::memory_order_relaxed); }
+
+            /**
+             * @brief Gets the number of begin_frame() calls
+             */
+            uint64_t frame_index() const { return mFrameIndex.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief Allocates a small block from the calling worker's pool without taking a lock
+             * @details Blocks up to small_block_pool::kMaxBlockSize bytes come from the worker's
+             *          size-class free lists, larger blocks and blocks requested outside a
+             *          worker come from the heap. The block is 16-byte aligned
+             */
+            static void* allocate_block(size_t pSize);
+
+            /**
+             * @brief Frees a block returned by allocate_block() from any thread
+             * @details Blocks of another worker are handed back to it through a lock-free list.
+             *          Pool blocks must be freed before their job system is destroyed
+             */
+            static void deallocate_block(void* pBlock);
+
             /**
              * @brief Prints performance statistics for each worker thread
-             * @details Shows the percentage of time each thread spent active vs idle
+             * @details Shows the percentage of time each thread spent active vs idle.
+             *          Only measured when CACAU_JOBS_PROFILING is enabled
              */
             void print_thread_utilization() const;
 
         private:
+            friend class task_arena;
+
+            /**
+             * @param pConfiguration Unused, taking it makes callers link against the library's configuration
+             */
+            job_system(size_t pThreadCount, int pConfiguration);
+
             /**
              * @brief Main worker thread function that processes jobs
              * @param thread_index Identifier for the worker thread
@@ -86,14 +344,204 @@ namespace cacau
              */
             bool steal_job(size_t pThreadIndex, job* &pStolenJob);
 
+            /**
+             * @brief Steals the highest ranked job among all other threads' ranked queues
+             */
+            bool steal_ranked_job(size_t pThreadIndex, job* &pStolenJob);
+
+            /**
+             * @brief Steals the job with the earliest deadline among all other threads' deadline queues
+             */
+            bool steal_deadline_job(size_t pThreadIndex, job* &pStolenJob);
+
+            /**
+             * @brief Applies the deadline miss policy to a job picked up after its deadline
+             * @return true if the job was dropped or deferred and must not run now
+             */
+            bool handle_expired_job(size_t pThreadIndex, job* pJob);
+
+            /**
+             * @brief Counts whether a job with a deadline finished in time
+             */
+            void record_deadline(const job* pJob, std::chrono::high_resolution_clock::time_point pEnd);
+
+            /**
+             * @brief Pops the next job from a thread's own queues: deadline jobs, then ranked jobs, then FIFO
+             */
+            bool pop_local_job(size_t pThreadIndex, job* &pJob);
+
+            /**
+             * @brief Pushes a job to a thread queue and wakes the workers
+             */
+            void push_job(size_t pThreadIndex, job* pJob);
+
+            /**
+             * @brief Wakes sleeping workers after work was queued
+             */
+            void wake_workers();
+
+            /**
+             * @brief Runs a job on a worker and counts it as completed, for its arena too if it has one
+             */
+            void run_job(size_t pThreadIndex, job* pJob, task_arena* pArena);
+
+            void register_arena(task_arena* pArena);
+            void unregister_arena(task_arena* pArena);
+
+            /**
+             * @brief Queues a job in an arena and wakes the workers
+             */
+            void push_arena_job(task_arena* pArena, job* pJob);
+
+            /**
+             * @brief Takes the next job of the arena whose turn it is
+             * @details Among the arenas with queued jobs and below their concurrency limit the one
+             *          with the lowest pass is picked, its pass then advances by kArenaStride / weight
+             */
+            bool pop_arena_job(job* &pJob, task_arena* &pArena);
+
+            /**
+             * @brief Blocks until an arena's jobs completed, workers run only that arena's jobs meanwhile
+             * @details Without CACAU_JOBS_TASK_ARENAS the arena's jobs are in the job system's
+             *          queues, workers then run any queued job meanwhile
+             */
+            void wait_for_arena(task_arena* pArena);
+
+            /**
+             * @brief Queues a job whose dependencies are resolved, preferring the calling worker's queue
+             */
+            void enqueue_ready_job(job* pJob);
+
+            /**
+             * @brief Computes the critical-path rank of a job before it is queued
+             */
+            void assign_rank(job* pJob);
+
+            /**
+             * @brief Raises the rank of a job's unfinished dependencies, transitively, above its own
+             * @details Lets dependencies submitted before their dependants still be ordered by the
+             *          critical path
+             */
+            void propagate_rank(job* pJob);
+
+            /**
+             * @brief Moves a job up its ranked heap after its mDownstreamRank was raised
+             * @details Heap keys only change under the heap's queue mutex. Jobs in no ranked heap
+             *          are left alone, push_job ranks them when they are queued
+             */
+            void raise_queued_rank(job* pJob);
+
+            /**
+             * @brief Adds an execution time sample to the per-name history
+             */
+            void record_execution_time(const char* pJobName, double pMicroseconds);
+
+            /**
+             * @brief Records the queue wait, ready wait and run time of a finished job
+             */
+            void record_latency(size_t pThreadIndex, const job* pJob,
+                                std::chrono::high_resolution_clock::time_point pStart,
+                                std::chrono::high_resolution_clock::time_point pEnd);
+
+            struct latency_key
+            {
+                const char* mName;  ///< nullptr when grouped by type id
+                uint32_t mTypeId;
+                bool operator==(const latency_key &pOther) const
+                {
+                    return mName == pOther.mName && mTypeId == pOther.mTypeId;
+                }
+            };
+
+            struct latency_key_hash
+            {
+                size_t operator()(const latency_key &pKey) const
+                {
+                    return std::hash<const char*>()(pKey.mName) ^ (std::hash<uint32_t>()(pKey.mTypeId) << 1);
+                }
+            };
+
+            /**
+             * @brief Latency histograms recorded by one worker, only contended while being queried
+             */
+            struct latency_shard
+            {
+                std::mutex mMutex;
+                std::unordered_map<latency_key, job_latency_stats, latency_key_hash> mStats;
+            };
+
+            job_latency_stats collect_latency_stats(const latency_key &pKey);
+
+            /**
+             * @brief Job run by submit_periodic(), shared by the timer wheel and its dispatched runs
+             */
+            struct periodic_timer
+            {
+                ~periodic_timer() { delete mJob; }
+
+                job* mJob;
+                uint64_t mIntervalTicks;
+                std::atomic<bool> mRunning{false};
+                std::atomic<bool> mCancelled{false};
+            };
+
+            struct timer_payload
+            {
+                job* mJob;                                  ///< One-shot job, nullptr for periodic timers
+                std::shared_ptr<periodic_timer> mPeriodic;
+            };
+
+            /**
+             * @brief Dispatches the jobs of every due timer to a thread's queue
+             * @return true if a job was dispatched
+             * @details Only one worker harvests at a time, the others go on without waiting
+             */
+            bool harvest_timers(size_t pThreadIndex);
+
+            /**
+             * @brief Converts a time point to timer wheel ticks, rounding up
+             */
+            uint64_t timer_tick(std::chrono::steady_clock::time_point pTime) const;
+
+            /**
+             * @brief Publishes the timer count and next due tick read by the workers, mTimerMutex must be held
+             */
+            void update_timer_state();
+
+            /**
+             * @brief Arenas freed by a worker after each job and each frame
+             */
+            struct worker_scratch
+            {
+                scratch_arena mJobScratch;
+                scratch_arena mFrameScratch;
+                uint64_t mFrame = 0; ///< Frame index mFrameScratch was last freed for
+            };
+
+            /**
+             * @brief Memory owned by one worker, only touched by that worker
+             */
+            struct worker_memory
+            {
+                feature_state<job_system_traits::kWorkerScratch, worker_scratch> mScratch;
+                small_block_pool mBlocks;
+            };
+
+            using job_heaps = std::vector<std::vector<job *>>;
+
             // Thread management
-            int mNextThread = 0;
+            std::atomic<size_t> mNextThread{0};
             std::vector<std::thread> mThreads;
             std::vector<std::deque<job *>> mThreadQueues;
+            feature_state<job_system_traits::kPriorityQueues, job_heaps> mRankedQueues; ///< Max-heaps on job::rank(), guarded by mQueueMutexes
+            feature_state<job_system_traits::kPriorityQueues, job_heaps> mDeadlineQueues; ///< Min-heaps on job::deadline(), guarded by mQueueMutexes
+            std::atomic<size_t> mRankedJobs{0};        ///< Jobs in all ranked heaps, lets steal_job skip them when empty
+            std::atomic<size_t> mDeadlineJobs{0};      ///< Jobs in all deadline heaps, lets steal_job skip them when empty
             std::vector<std::mutex> mQueueMutexes;
             std::condition_variable mCondition;
             std::mutex mGlobalMutex;
-            bool mStop;
+            std::atomic<bool> mStop;
+            std::atomic<size_t> mSleepingWorkers{0}; ///< Workers blocked on mCondition, guarded by mGlobalMutex for writes
 
             // Job tracking
             std::atomic<bool> mJobSystemPaused{true};
@@ -101,7 +549,44 @@ namespace cacau
             std::atomic<size_t> mCompletedJobs{0};
             //double m_total_execution_time{0.0};
             std::mutex mExecutionTimeMutex;
-            std::vector<job *> mJobsWaitingForDependencies;
+            std::atomic<size_t> mWaitingJobs{0};   ///< Jobs whose dependencies are not resolved yet
+
+            // Critical-path scheduling
+            std::atomic<scheduling_mode> mSchedulingMode{scheduling_mode::fifo};
+            feature_state<job_system_traits::kPriorityQueues, execution_history> mExecutionHistory;
+
+            // Deadlines
+            std::atomic<deadline_miss_policy> mDeadlineMissPolicy{deadline_miss_policy::run};
+            std::atomic<uint64_t> mDeadlinesMet{0};
+            std::atomic<uint64_t> mDeadlinesMissed{0};
+            std::atomic<uint64_t> mDeadlinesDropped{0};
+            std::atomic<uint64_t> mDeadlinesDeferred{0};
+
+            // Latency histograms
+            std::atomic<bool> mLatencyTracking{false};
+            feature_state<job_system_traits::kTracing, std::vector<latency_shard>> mLatencyShards;
+
+            // Worker-local memory
+            std::vector<worker_memory> mWorkerMemory;
+            std::atomic<uint64_t> mFrameIndex{0};
+
+            // Timers
+            std::mutex mTimerMutex;
+            timer_wheel<timer_payload> mTimers;
+            std::unordered_map<uint64_t, std::shared_ptr<periodic_timer>> mPeriodicTimers;
+            uint64_t mNextTimerId = 1;
+            std::chrono::steady_clock::time_point mTimerEpoch;
+            std::atomic<size_t> mTimerCount{0};
+            std::atomic<uint64_t> mNextTimerTick{~uint64_t(0)}; ///< Earliest tick a timer may be due at
+            std::atomic<size_t> mPendingTimerJobs{0};           ///< One-shot timers not dispatched yet
+
+            // Task arenas. One lock for all arenas keeps stride scheduling simple; it is only
+            // taken while arena jobs are queued, but it is the limit with many workers and
+            // very short arena jobs
+            mutable std::mutex mArenaMutex;   ///< Guards the arena list and the queues, limits and passes of every arena
+            std::vector<task_arena *> mArenas;
+            std::atomic<size_t> mQueuedArenaJobs{0}; ///< Jobs in all arena queues, checked before taking mArenaMutex
+            uint64_t mArenaPass = 0;          ///< Pass of the arena picked last, arenas becoming active start from it
 
             // Performance monitoring
             std::vector<std::mutex> mProfilingMutexes;
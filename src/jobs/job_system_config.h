@@ -0,0 +1,178 @@
+#pragma once
+#include <cstdlib>
+#include <utility>
+
+// Compile-time configuration of the job system.
+//
+// Every feature that costs time on the worker hot path can be compiled out by
+// defining its macro to 0, or all of them at once with CACAU_JOBS_MINIMAL.
+// The macros change the layout of job and job_system, so the library and every
+// translation unit using it must see the same values: set them through the CMake
+// options, which add them to the library's public compile definitions. A program
+// built with other values than its library fails to link instead of misbehaving.
+// The public API stays the same, disabled features do nothing: their setters return
+// false, their statistics stay empty and their print functions say they are compiled out.
+// The state they keep in every job and in the job system is compiled out with them.
+//
+//   CACAU_JOBS_PROFILING        Thread utilization timers (print_thread_utilization)
+//   CACAU_JOBS_TRACING          Latency histograms
+//   CACAU_JOBS_PRIORITY_QUEUES  Critical-path and earliest-deadline queues, deadline miss policies and
+//                               counters, execution time history. FIFO only when 0
+//   CACAU_JOBS_WORKER_SCRATCH   Per-job and per-frame scratch arenas freed by the workers. When 0, scratch()
+//                               and frame_scratch() return arenas of the calling thread that only reset() frees
+//   CACAU_JOBS_TIMERS           Workers dispatch submit_after()/submit_periodic() jobs. When 0 both refuse
+//                               the job and leave it to the caller
+//   CACAU_JOBS_TASK_ARENAS      Arena queues, concurrency limits and weights. When 0 arena jobs go to the
+//                               job system's queues and waiting on an arena runs any queued job meanwhile
+//   CACAU_JOBS_SLEEPING_WORKERS Idle workers sleep on a condition variable, they yield for a while first when 0
+//   CACAU_JOBS_POOLED_JOBS      Jobs are allocated from per-thread block pools instead of the heap
+//
+// The last two are policies rather than features. CACAU_JOBS_MINIMAL leaves the wake
+// policy alone, spinning trades idle cores for wake-up latency and is chosen per
+// workload. It does switch to pooled jobs, which only make submitting cheaper.
+
+#ifdef CACAU_JOBS_MINIMAL
+    #define CACAU_JOBS_DEFAULT_FEATURE 0
+#else
+    #define CACAU_JOBS_DEFAULT_FEATURE 1
+#endif
+
+#ifndef CACAU_JOBS_PROFILING
+    #define CACAU_JOBS_PROFILING CACAU_JOBS_DEFAULT_FEATURE
+#endif
+
+#ifndef CACAU_JOBS_TRACING
+    #define CACAU_JOBS_TRACING CACAU_JOBS_DEFAULT_FEATURE
+#endif
+
+#ifndef CACAU_JOBS_PRIORITY_QUEUES
+    #define CACAU_JOBS_PRIORITY_QUEUES CACAU_JOBS_DEFAULT_FEATURE
+#endif
+
+#ifndef CACAU_JOBS_WORKER_SCRATCH
+    #define CACAU_JOBS_WORKER_SCRATCH CACAU_JOBS_DEFAULT_FEATURE
+#endif
+
+#ifndef CACAU_JOBS_TIMERS
+    #define CACAU_JOBS_TIMERS CACAU_JOBS_DEFAULT_FEATURE
+#endif
+
+#ifndef CACAU_JOBS_TASK_ARENAS
+    #define CACAU_JOBS_TASK_ARENAS CACAU_JOBS_DEFAULT_FEATURE
+#endif
+
+#ifndef CACAU_JOBS_SLEEPING_WORKERS
+    #define CACAU_JOBS_SLEEPING_WORKERS 1
+#endif
+
+#ifndef CACAU_JOBS_POOLED_JOBS
+    #ifdef CACAU_JOBS_MINIMAL
+        #define CACAU_JOBS_POOLED_JOBS 1
+    #else
+        #define CACAU_JOBS_POOLED_JOBS 0
+    #endif
+#endif
+
+// Name of a symbol defined by the library for the configuration it was built with
+#define CACAU_JOBS_CONFIGURATION_NAME(pProfiling, pTracing, pPriorityQueues, pScratch, pTimers, pArenas, pSleeping, pPooled) \
+    built_with_profiling##pProfiling##_tracing##pTracing##_priority_queues##pPriorityQueues##_worker_scratch##pScratch## \
+    _timers##pTimers##_task_arenas##pArenas##_sleeping_workers##pSleeping##_pooled_jobs##pPooled
+#define CACAU_JOBS_CONFIGURATION_EXPAND(...) CACAU_JOBS_CONFIGURATION_NAME(__VA_ARGS__)
+#define CACAU_JOBS_CONFIGURATION CACAU_JOBS_CONFIGURATION_EXPAND(CACAU_JOBS_PROFILING, CACAU_JOBS_TRACING, \
+    CACAU_JOBS_PRIORITY_QUEUES, CACAU_JOBS_WORKER_SCRATCH, CACAU_JOBS_TIMERS, CACAU_JOBS_TASK_ARENAS, \
+    CACAU_JOBS_SLEEPING_WORKERS, CACAU_JOBS_POOLED_JOBS)
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    /**
+     * @brief Defined by the library only, under the name of the configuration it was built with
+     * @details Read by the inline job_system constructor, so code compiled with other
+     *          configuration macros than the library references a missing symbol
+     */
+    extern const int CACAU_JOBS_CONFIGURATION;
+
+    /**
+     * @brief How idle workers wait for new jobs
+     */
+    enum class wake_policy
+    {
+        sleep, ///< Block on a condition variable, submitters notify
+        spin   ///< Yield in a loop for a few milliseconds before sleeping, lowest wake-up latency
+    };
+
+    /**
+     * @brief How job objects are allocated by `new job(...)`
+     */
+    enum class allocator_policy
+    {
+        heap, ///< Global operator new/delete
+        pool  ///< Per-thread fixed-size block caches backed by a shared free list
+    };
+
+    /**
+     * @brief Compile-time feature selection used by the job system implementation
+     * @details Features are tested with plain `if (job_system_traits::...)`, so disabled
+     *          branches and the state they read are removed by the compiler
+     */
+    struct job_system_traits
+    {
+        static constexpr bool kProfiling = CACAU_JOBS_PROFILING != 0;
+        static constexpr bool kTracing = CACAU_JOBS_TRACING != 0;
+        static constexpr bool kPriorityQueues = CACAU_JOBS_PRIORITY_QUEUES != 0;
+        static constexpr bool kWorkerScratch = CACAU_JOBS_WORKER_SCRATCH != 0;
+        static constexpr bool kTimers = CACAU_JOBS_TIMERS != 0;
+        static constexpr bool kTaskArenas = CACAU_JOBS_TASK_ARENAS != 0;
+        static constexpr wake_policy kWakePolicy =
+            CACAU_JOBS_SLEEPING_WORKERS ? wake_policy::sleep : wake_policy::spin;
+        static constexpr allocator_policy kAllocatorPolicy =
+            CACAU_JOBS_POOLED_JOBS ? allocator_policy::pool : allocator_policy::heap;
+
+        /**
+         * @brief Short description of the configuration, for benchmark output
+         */
+        static const char* name()
+        {
+            return kProfiling && kTracing && kPriorityQueues && kWorkerScratch && kTimers && kTaskArenas &&
+                   kWakePolicy == wake_policy::sleep
+                ? "full"
+                : (!kProfiling && !kTracing && !kPriorityQueues && !kWorkerScratch && !kTimers && !kTaskArenas
+                   ? "minimal" : "custom");
+        }
+    };
+
+    /**
+     * @brief State of an optional feature, stored only while the feature is compiled in
+     * @details Code using the state is still compiled when the feature is off, behind its
+     *          `if (job_system_traits::...)`, so the state keeps its type. get() of a disabled
+     *          feature is never reached and aborts if it is
+     */
+    template <bool Enabled, typename T>
+    class feature_state
+    {
+    public:
+        template <typename... Args>
+        explicit feature_state(Args&&... pArgs) : mValue(std::forward<Args>(pArgs)...) {}
+
+        T &get() { return mValue; }
+        const T &get() const { return mValue; }
+
+    private:
+        T mValue;
+    };
+
+    template <typename T>
+    class feature_state<false, T>
+    {
+    public:
+        template <typename... Args>
+        explicit feature_state(Args&&...) {}
+
+        T &get() { std::abort(); }
+        const T &get() const { std::abort(); }
+    };
+
+    } // namespace jobs
+} // namespace cacau
@@ -0,0 +1,119 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    namespace
+    {
+        // Index of the highest set bit, pValue must not be zero
+        size_t highest_bit(uint64_t pValue)
+        {
+        #if defined(__GNUC__) || defined(__clang__)
+            return 63 - static_cast<size_t>(__builtin_clzll(pValue));
+        #else
+            size_t bit = 0;
+            while (pValue >>= 1)
+            {
+                ++bit;
+            }
+            return bit;
+        #endif
+        }
+    }
+
+    constexpr size_t latency_histogram::kSubBucketBits;
+    constexpr size_t latency_histogram::kSubBucketCount;
+    constexpr size_t latency_histogram::kMaxExponent;
+    constexpr size_t latency_histogram::kBucketCount;
+
+    size_t latency_histogram::bucket_index(uint64_t pValue)
+    {
+        if (pValue < kSubBucketCount)
+        {
+            return static_cast<size_t>(pValue);
+        }
+
+        size_t exponent = std::min(highest_bit(pValue), kMaxExponent);
+        if (exponent == kMaxExponent)
+        {
+            return kBucketCount - 1;
+        }
+
+        // Linear sub-bucket inside [2^exponent, 2^(exponent + 1))
+        size_t subBucket = static_cast<size_t>(pValue >> (exponent - kSubBucketBits)) & (kSubBucketCount - 1);
+        return kSubBucketCount * (exponent - kSubBucketBits + 1) + subBucket;
+    }
+
+    uint64_t latency_histogram::bucket_upper_bound(size_t pIndex)
+    {
+        if (pIndex < kSubBucketCount)
+        {
+            return pIndex;
+        }
+
+        size_t exponent = pIndex / kSubBucketCount + kSubBucketBits - 1;
+        uint64_t subBucket = pIndex % kSubBucketCount;
+        uint64_t width = uint64_t(1) << (exponent - kSubBucketBits);
+        return (uint64_t(1) << exponent) + (subBucket + 1) * width - 1;
+    }
+
+    void latency_histogram::record(uint64_t pNanoseconds)
+    {
+        ++mBuckets[bucket_index(pNanoseconds)];
+        ++mCount;
+        mSum += pNanoseconds;
+        mMin = std::min(mMin, pNanoseconds);
+        mMax = std::max(mMax, pNanoseconds);
+    }
+
+    void latency_histogram::merge(const latency_histogram &pOther)
+    {
+        for (size_t i = 0; i < kBucketCount; ++i)
+        {
+            mBuckets[i] += pOther.mBuckets[i];
+        }
+        mCount += pOther.mCount;
+        mSum += pOther.mSum;
+        mMin = std::min(mMin, pOther.mMin);
+        mMax = std::max(mMax, pOther.mMax);
+    }
+
+    void latency_histogram::reset()
+    {
+        mBuckets.fill(0);
+        mCount = 0;
+        mSum = 0;
+        mMin = UINT64_MAX;
+        mMax = 0;
+    }
+
+    uint64_t latency_histogram::percentile(double pPercentile) const
+    {
+        if (mCount == 0)
+        {
+            return 0;
+        }
+
+        double clamped = std::min(std::max(pPercentile, 0.0), 100.0);
+        uint64_t target = static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(mCount)));
+        target = std::max<uint64_t>(target, 1);
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i)
+        {
+            seen += mBuckets[i];
+            if (seen >= target && i + 1 < kBucketCount)
+            {
+                // The bucket bound can overshoot the largest sample actually recorded
+                return std::min(bucket_upper_bound(i), mMax);
+            }
+        }
+        return mMax;
+    }
+
+    } // namespace jobs
+} // namespace cacau
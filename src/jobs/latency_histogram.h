@@ -0,0 +1,68 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    /**
+     * @brief Log-bucketed (HDR style) histogram of durations in nanoseconds
+     * @details Values below 16 ns are stored exactly, larger values in 16 linear sub-buckets
+     *          per power of two, which bounds the relative error to ~6%. Values above
+     *          ~18 minutes are clamped into the last bucket. Not thread-safe, the job system
+     *          keeps one histogram per worker and merges them on query
+     */
+    class latency_histogram
+    {
+    public:
+        static constexpr size_t kSubBucketBits = 4;
+        static constexpr size_t kSubBucketCount = size_t(1) << kSubBucketBits;
+        static constexpr size_t kMaxExponent = 40;  ///< 2^40 ns, ~18 minutes
+        static constexpr size_t kBucketCount = kSubBucketCount * (kMaxExponent - kSubBucketBits + 1) + 1;
+
+        latency_histogram() { reset(); }
+
+        /**
+         * @brief Adds one sample
+         * @param pNanoseconds Duration of the sample
+         */
+        void record(uint64_t pNanoseconds);
+
+        /**
+         * @brief Adds all samples of another histogram to this one
+         */
+        void merge(const latency_histogram &pOther);
+
+        /**
+         * @brief Removes all samples
+         */
+        void reset();
+
+        /**
+         * @brief Gets the value below which the given fraction of samples fall
+         * @param pPercentile Percentile in [0, 100], e.g. 99.9
+         * @return Upper bound of the matching bucket in nanoseconds, or 0 if empty
+         */
+        uint64_t percentile(double pPercentile) const;
+
+        uint64_t count() const { return mCount; }
+        uint64_t min() const { return mCount > 0 ? mMin : 0; }
+        uint64_t max() const { return mMax; }
+        double mean() const { return mCount > 0 ? static_cast<double>(mSum) / mCount : 0.0; }
+
+    private:
+        static size_t bucket_index(uint64_t pValue);
+        static uint64_t bucket_upper_bound(size_t pIndex);
+
+        std::array<uint64_t, kBucketCount> mBuckets;
+        uint64_t mCount;
+        uint64_t mSum;
+        uint64_t mMin;
+        uint64_t mMax;
+    };
+
+    } // namespace jobs
+} // namespace cacau
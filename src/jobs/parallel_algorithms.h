@@ -0,0 +1,445 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "job_system.h"
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    /**
+     * @brief Default number of elements below which the algorithms run serially on the caller
+     */
+    constexpr size_t kParallelGrain = 16 * 1024;
+
+    /**
+     * @brief Bytes sorted serially per run by parallel_sort, sized to stay inside a core's L2 cache
+     */
+    constexpr size_t kSortRunBytes = 256 * 1024;
+
+    namespace detail
+    {
+        /**
+         * @brief Chunk counters shared by the caller and the helper jobs of one parallel loop
+         */
+        struct chunk_loop_state
+        {
+            explicit chunk_loop_state(size_t pCount)
+                : mCount(pCount)
+                , mNext(0)
+                , mDone(0) {}
+
+            const size_t mCount;
+            std::atomic<size_t> mNext;
+            std::atomic<size_t> mDone;
+        };
+
+        /**
+         * @brief Runs chunks until none is left to claim
+         * @details pBody is only dereferenced for a claimed chunk: the caller of parallel_chunks
+         *          returns once every claimed chunk is done, destroying the body with it
+         */
+        template <typename Body>
+        void run_chunks(chunk_loop_state &pState, Body *pBody)
+        {
+            size_t index;
+            while ((index = pState.mNext.fetch_add(1, std::memory_order_relaxed)) < pState.mCount)
+            {
+                (*pBody)(index);
+                pState.mDone.fetch_add(1, std::memory_order_release);
+            }
+        }
+
+        /**
+         * @brief Calls pBody(i) for every i in [0, pChunkCount), in parallel
+         * @details Submits at most one helper job per worker and runs chunks on the calling
+         *          thread too, every participant claims the next chunk from a shared counter.
+         *          The caller never waits for a chunk nobody claimed, so this is safe from
+         *          inside a job and from a paused or fully busy job system. The pause state is
+         *          left as it is, a paused job system leaves every chunk to the caller. Helper
+         *          jobs that start after every chunk was claimed only touch the shared counters
+         */
+        template <typename Body>
+        void parallel_chunks(job_system &pJobSystem, size_t pChunkCount, Body &pBody, const char* pName)
+        {
+            if (pChunkCount == 0)
+            {
+                return;
+            }
+
+            std::shared_ptr<chunk_loop_state> state = std::make_shared<chunk_loop_state>(pChunkCount);
+            size_t helpers = std::min(pJobSystem.thread_count(), pChunkCount - 1);
+            Body *body = &pBody;
+            for (size_t i = 0; i < helpers; ++i)
+            {
+                pJobSystem.submit(new job([state, body] { run_chunks(*state, body); }, pName));
+            }
+
+            run_chunks(*state, body);
+            while (state->mDone.load(std::memory_order_acquire) < pChunkCount)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        /**
+         * @brief Number of chunks for pCount elements: a few per worker to balance load, none below pGrain
+         */
+        inline size_t chunk_count(const job_system &pJobSystem, size_t pCount, size_t pGrain)
+        {
+            size_t byGrain = (pCount + pGrain - 1) / std::max<size_t>(pGrain, 1);
+            return std::min(byGrain, (pJobSystem.thread_count() + 1) * 4);
+        }
+
+        /**
+         * @brief Number of elements of A among the first pOutput elements of merge(A, B)
+         * @details Ties are taken from A first, as std::merge does
+         */
+        template <typename It, typename Compare>
+        size_t merge_split(It pA, size_t pSizeA, It pB, size_t pSizeB, size_t pOutput, Compare &pCompare)
+        {
+            size_t low = pOutput > pSizeB ? pOutput - pSizeB : 0;
+            size_t high = std::min(pOutput, pSizeA);
+            while (low < high)
+            {
+                size_t i = low + (high - low) / 2;
+                size_t j = pOutput - i;
+                if (pCompare(pB[j - 1], pA[i]))
+                {
+                    high = i;
+                }
+                else
+                {
+                    low = i + 1;
+                }
+            }
+            return low;
+        }
+
+        /**
+         * @brief Merges neighbouring sorted runs of pSource pairwise into pTarget
+         * @details Every merge is cut into output pieces of about pGrain elements, so the last
+         *          rounds, with only a couple of long runs left, still use every worker
+         * @param pRuns Run boundaries, first is 0 and last is the element count. Updated to the merged runs
+         */
+        template <typename SourceIt, typename TargetIt, typename Compare>
+        void merge_round(job_system &pJobSystem, SourceIt pSource, TargetIt pTarget,
+                         std::vector<size_t> &pRuns, size_t pGrain, Compare &pCompare)
+        {
+            struct piece
+            {
+                size_t mBegin;
+                size_t mMiddle;
+                size_t mEnd;
+                size_t mOutputBegin;
+                size_t mOutputEnd;
+            };
+
+            std::vector<piece> pieces;
+            std::vector<size_t> merged;
+            merged.push_back(0);
+            for (size_t r = 0; r + 1 < pRuns.size(); r += 2)
+            {
+                size_t begin = pRuns[r];
+                size_t middle = pRuns[r + 1];
+                size_t end = r + 2 < pRuns.size() ? pRuns[r + 2] : middle;
+                for (size_t output = 0; output < end - begin; output += pGrain)
+                {
+                    pieces.push_back(piece{begin, middle, end, output, std::min(output + pGrain, end - begin)});
+                }
+                merged.push_back(end);
+            }
+
+            auto mergePiece = [&pieces, pSource, pTarget, &pCompare](size_t pIndex)
+            {
+                const piece &current = pieces[pIndex];
+                SourceIt a = pSource + current.mBegin;
+                SourceIt b = pSource + current.mMiddle;
+                size_t sizeA = current.mMiddle - current.mBegin;
+                size_t sizeB = current.mEnd - current.mMiddle;
+                size_t a0 = merge_split(a, sizeA, b, sizeB, current.mOutputBegin, pCompare);
+                size_t a1 = merge_split(a, sizeA, b, sizeB, current.mOutputEnd, pCompare);
+                size_t b0 = current.mOutputBegin - a0;
+                size_t b1 = current.mOutputEnd - a1;
+                std::merge(std::make_move_iterator(a + a0), std::make_move_iterator(a + a1),
+                           std::make_move_iterator(b + b0), std::make_move_iterator(b + b1),
+                           pTarget + current.mBegin + current.mOutputBegin, pCompare);
+            };
+            parallel_chunks(pJobSystem, pieces.size(), mergePiece, "ParallelMerge");
+
+            pRuns.swap(merged);
+        }
+    }
+
+    /**
+     * @brief Applies pOperation to every element of [pFirst, pLast) and writes the results to pOutput
+     * @details Runs on pJobSystem's workers and the calling thread, like std::transform the
+     *          output may alias the input
+     * @param pGrain Smallest number of elements processed by one chunk
+     * @return Iterator past the last written element
+     */
+    template <typename InputIt, typename OutputIt, typename UnaryOperation>
+    OutputIt parallel_transform(job_system &pJobSystem, InputIt pFirst, InputIt pLast, OutputIt pOutput,
+                                UnaryOperation pOperation, size_t pGrain = kParallelGrain)
+    {
+        size_t count = static_cast<size_t>(pLast - pFirst);
+        size_t chunks = detail::chunk_count(pJobSystem, count, pGrain);
+        auto body = [=, &pOperation](size_t pChunk)
+        {
+            size_t begin = count * pChunk / chunks;
+            size_t end = count * (pChunk + 1) / chunks;
+            std::transform(pFirst + begin, pFirst + end, pOutput + begin, pOperation);
+        };
+        detail::parallel_chunks(pJobSystem, chunks, body, "ParallelTransform");
+        return pOutput + count;
+    }
+
+    /**
+     * @brief Finds the first element of [pFirst, pLast) satisfying pPredicate
+     * @details Chunks are claimed front to back. Once a match is found, chunks after it are
+     *          skipped and chunks in progress stop at their next check, so only work before
+     *          the first match is guaranteed to be done
+     * @return Iterator to the first match, or pLast
+     */
+    template <typename RandomIt, typename Predicate>
+    RandomIt parallel_find_if(job_system &pJobSystem, RandomIt pFirst, RandomIt pLast, Predicate pPredicate,
+                              size_t pGrain = kParallelGrain)
+    {
+        // Elements scanned between checks for an earlier match
+        constexpr size_t kCheckInterval = 1024;
+
+        size_t count = static_cast<size_t>(pLast - pFirst);
+        size_t chunks = std::max<size_t>((count + pGrain - 1) / std::max<size_t>(pGrain, 1), 1);
+        std::atomic<size_t> found(count);
+        auto body = [=, &pPredicate, &found](size_t pChunk)
+        {
+            size_t begin = count * pChunk / chunks;
+            size_t end = count * (pChunk + 1) / chunks;
+            for (size_t i = begin; i < end; i += kCheckInterval)
+            {
+                if (found.load(std::memory_order_relaxed) < i)
+                {
+                    return;
+                }
+
+                size_t stop = std::min(i + kCheckInterval, end);
+                for (size_t k = i; k < stop; ++k)
+                {
+                    if (pPredicate(pFirst[k]))
+                    {
+                        size_t current = found.load(std::memory_order_relaxed);
+                        while (k < current && !found.compare_exchange_weak(current, k, std::memory_order_relaxed))
+                        {
+                        }
+                        return;
+                    }
+                }
+            }
+        };
+        detail::parallel_chunks(pJobSystem, chunks, body, "ParallelFindIf");
+        return pFirst + found.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Reorders [pFirst, pLast) so elements satisfying pPredicate come first, like std::partition
+     * @details Every chunk is partitioned in place, then the elements on the wrong side of the
+     *          final split point are swapped pairwise in parallel. Not stable
+     * @return Iterator to the first element not satisfying pPredicate
+     */
+    template <typename RandomIt, typename Predicate>
+    RandomIt parallel_partition(job_system &pJobSystem, RandomIt pFirst, RandomIt pLast, Predicate pPredicate,
+                                size_t pGrain = kParallelGrain)
+    {
+        size_t count = static_cast<size_t>(pLast - pFirst);
+        size_t chunks = detail::chunk_count(pJobSystem, count, pGrain);
+        if (chunks <= 1)
+        {
+            return std::partition(pFirst, pLast, pPredicate);
+        }
+
+        // Partition every chunk, remembering its split point
+        std::vector<size_t> splits(chunks);
+        auto partitionChunk = [=, &pPredicate, &splits](size_t pChunk)
+        {
+            RandomIt begin = pFirst + count * pChunk / chunks;
+            RandomIt end = pFirst + count * (pChunk + 1) / chunks;
+            splits[pChunk] = static_cast<size_t>(std::partition(begin, end, pPredicate) - pFirst);
+        };
+        detail::parallel_chunks(pJobSystem, chunks, partitionChunk, "ParallelPartition");
+
+        size_t split = 0;
+        for (size_t i = 0; i < chunks; ++i)
+        {
+            split += splits[i] - count * i / chunks;
+        }
+
+        // Failing elements left of the split and passing ones right of it, in equal numbers
+        std::vector<size_t> leftRanges;  // Pairs of [begin, end)
+        std::vector<size_t> rightRanges;
+        for (size_t i = 0; i < chunks; ++i)
+        {
+            size_t begin = count * i / chunks;
+            size_t end = count * (i + 1) / chunks;
+            size_t leftBegin = splits[i];
+            size_t leftEnd = std::min(end, split);
+            if (leftBegin < leftEnd)
+            {
+                leftRanges.push_back(leftBegin);
+                leftRanges.push_back(leftEnd);
+            }
+            size_t rightBegin = std::max(begin, split);
+            size_t rightEnd = splits[i];
+            if (rightBegin < rightEnd)
+            {
+                rightRanges.push_back(rightBegin);
+                rightRanges.push_back(rightEnd);
+            }
+        }
+
+        size_t misplaced = 0;
+        for (size_t i = 0; i < leftRanges.size(); i += 2)
+        {
+            misplaced += leftRanges[i + 1] - leftRanges[i];
+        }
+
+        // Swap the k-th misplaced element on the left with the k-th one on the right
+        size_t swapChunks = detail::chunk_count(pJobSystem, misplaced, pGrain);
+        auto swapChunk = [=, &leftRanges, &rightRanges](size_t pChunk)
+        {
+            size_t first = misplaced * pChunk / swapChunks;
+            size_t last = misplaced * (pChunk + 1) / swapChunks;
+
+            // Position of the first misplaced element of this chunk in both range lists
+            size_t left = 0;
+            size_t right = 0;
+            size_t leftSkip = first;
+            size_t rightSkip = first;
+            while (leftSkip >= leftRanges[left + 1] - leftRanges[left])
+            {
+                leftSkip -= leftRanges[left + 1] - leftRanges[left];
+                left += 2;
+            }
+            while (rightSkip >= rightRanges[right + 1] - rightRanges[right])
+            {
+                rightSkip -= rightRanges[right + 1] - rightRanges[right];
+                right += 2;
+            }
+
+            size_t leftIndex = leftRanges[left] + leftSkip;
+            size_t rightIndex = rightRanges[right] + rightSkip;
+            for (size_t k = first; k < last; ++k)
+            {
+                if (leftIndex == leftRanges[left + 1])
+                {
+                    left += 2;
+                    leftIndex = leftRanges[left];
+                }
+                if (rightIndex == rightRanges[right + 1])
+                {
+                    right += 2;
+                    rightIndex = rightRanges[right];
+                }
+                std::iter_swap(pFirst + leftIndex++, pFirst + rightIndex++);
+            }
+        };
+        detail::parallel_chunks(pJobSystem, swapChunks, swapChunk, "ParallelPartitionSwap");
+
+        return pFirst + split;
+    }
+
+    /**
+     * @brief Sorts [pFirst, pLast) with pCompare, like std::sort
+     * @details Parallel merge sort: runs of kSortRunBytes, small enough to be sorted inside a
+     *          core's cache, are sorted with std::sort, then merged pairwise in rounds between
+     *          the range and a temporary buffer of the same size. Every run is moved into the
+     *          buffer by the chunk that sorted it, so no pass over the whole range is serial.
+     *          Not stable
+     * @param pGrain Sorts with fewer elements run serially on the caller
+     */
+    template <typename RandomIt, typename Compare>
+    void parallel_sort(job_system &pJobSystem, RandomIt pFirst, RandomIt pLast, Compare pCompare,
+                       size_t pGrain = kParallelGrain)
+    {
+        typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+
+        size_t count = static_cast<size_t>(pLast - pFirst);
+        if (count <= pGrain || pJobSystem.thread_count() == 0)
+        {
+            std::sort(pFirst, pLast, pCompare);
+            return;
+        }
+
+        // Cache-sized runs, but enough of them to keep every worker busy
+        size_t runLength = std::max<size_t>(kSortRunBytes / sizeof(value_type), 1024);
+        size_t runCount = std::max((count + runLength - 1) / runLength, (pJobSystem.thread_count() + 1) * 2);
+        runCount = std::min(runCount, (count + pGrain - 1) / pGrain);
+
+        std::vector<size_t> runs(runCount + 1);
+        for (size_t i = 0; i <= runCount; ++i)
+        {
+            runs[i] = count * i / runCount;
+        }
+
+        // Sorted runs are move-constructed into the buffer while still in cache
+        std::allocator<value_type> allocator;
+        value_type *buffer = allocator.allocate(count);
+        auto sortRun = [&runs, pFirst, buffer, &pCompare](size_t pRun)
+        {
+            std::sort(pFirst + runs[pRun], pFirst + runs[pRun + 1], pCompare);
+            std::uninitialized_copy(std::make_move_iterator(pFirst + runs[pRun]),
+                                    std::make_move_iterator(pFirst + runs[pRun + 1]), buffer + runs[pRun]);
+        };
+        detail::parallel_chunks(pJobSystem, runCount, sortRun, "ParallelSortRun");
+
+        // Ping-pong between the buffer and the range until a single run is left
+        bool inBuffer = true;
+        while (runs.size() > 2)
+        {
+            if (inBuffer)
+            {
+                detail::merge_round(pJobSystem, buffer, pFirst, runs, pGrain, pCompare);
+            }
+            else
+            {
+                detail::merge_round(pJobSystem, pFirst, buffer, runs, pGrain, pCompare);
+            }
+            inBuffer = !inBuffer;
+        }
+
+        if (inBuffer)
+        {
+            parallel_transform(pJobSystem, std::make_move_iterator(buffer), std::make_move_iterator(buffer + count),
+                               pFirst, [](value_type &&pValue) -> value_type&& { return std::move(pValue); }, pGrain);
+        }
+
+        if (!std::is_trivially_destructible<value_type>::value)
+        {
+            auto destroyRun = [buffer, count, runCount](size_t pRun)
+            {
+                for (size_t i = count * pRun / runCount; i < count * (pRun + 1) / runCount; ++i)
+                {
+                    buffer[i].~value_type();
+                }
+            };
+            detail::parallel_chunks(pJobSystem, runCount, destroyRun, "ParallelSortDestroy");
+        }
+        allocator.deallocate(buffer, count);
+    }
+
+    /**
+     * @brief Sorts [pFirst, pLast) in ascending order
+     */
+    template <typename RandomIt>
+    void parallel_sort(job_system &pJobSystem, RandomIt pFirst, RandomIt pLast)
+    {
+        parallel_sort(pJobSystem, pFirst, pLast, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+    }
+
+    } // namespace jobs
+} // namespace cacau
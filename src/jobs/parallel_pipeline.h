@@ -0,0 +1,307 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "job_system.h"
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    /**
+     * @brief How a pipeline stage may run relative to other items
+     */
+    enum class pipeline_stage_mode
+    {
+        serial_in_order,  ///< One item at a time, in the order the source produced them
+        serial_any_order, ///< One item at a time, in any order
+        parallel          ///< Any number of items at once
+    };
+
+    /**
+     * @brief Streaming pipeline with a bounded number of items in flight
+     * @details The source fills items one at a time, then every item runs through the stages
+     *          in order. At most pTokenLimit items exist at once: they are allocated up front
+     *          and reused, so memory does not grow with the input size.
+     *          Each item is carried through all stages by the same job, so it stays on one
+     *          worker and in its cache. Only when it reaches a serial stage that is busy, or
+     *          not its turn yet, it is parked there, and the job that frees the stage resubmits it.
+     *          When an item leaves the last stage its job reuses the slot to read the next one
+     * @tparam Item Default-constructible work item, reused for many inputs (e.g. holding buffers)
+     */
+    template <typename Item>
+    class parallel_pipeline
+    {
+    public:
+        /**
+         * @param pJobSystem Job system running the stages
+         * @param pTokenLimit Maximum number of items in flight, at least 1
+         * @param pName Name of the pipeline jobs (used in logging and statistics)
+         */
+        parallel_pipeline(job_system &pJobSystem, size_t pTokenLimit, const char* pName = "Pipeline")
+            : mJobSystem(pJobSystem)
+            , mName(pName)
+            , mItems(pTokenLimit > 0 ? pTokenLimit : 1)
+            , mSequences(mItems.size(), 0)
+            , mSourceBusy(false)
+            , mSourceDone(false)
+            , mNextSequence(0)
+            , mReleasedTokens(0)
+            , mProcessedItems(0) {}
+
+        /**
+         * @brief Sets the serial first stage filling an item
+         * @param pSource Returns false once the input is exhausted, the item is then discarded
+         */
+        parallel_pipeline &set_source(std::function<bool(Item &)> pSource)
+        {
+            mSource = std::move(pSource);
+            return *this;
+        }
+
+        /**
+         * @brief Appends a stage, stages run in the order they were added
+         */
+        parallel_pipeline &add_stage(pipeline_stage_mode pMode, std::function<void(Item &)> pFunction)
+        {
+            mStages.emplace_back(new stage(pMode, std::move(pFunction)));
+            return *this;
+        }
+
+        /**
+         * @brief Runs the pipeline until the source is exhausted and every item left the last stage
+         * @details Blocks the calling thread, which must not be a worker of the job system
+         */
+        void run()
+        {
+            mSourceDone = false;
+            mNextSequence = 0;
+            mReleasedTokens = 0;
+            mProcessedItems = 0;
+            for (auto &current : mStages)
+            {
+                current->mNextSequence = 0;
+            }
+
+            // Every token but the first waits for the source, each read hands it to the next
+            mFreeTokens.clear();
+            for (size_t token = mItems.size(); token-- > 1;)
+            {
+                mFreeTokens.push_back(token);
+            }
+            submit_token(0, 0, false);
+
+            mJobSystem.resume();
+            while (mReleasedTokens.load(std::memory_order_acquire) < mItems.size())
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        size_t token_limit() const { return mItems.size(); }
+
+        /**
+         * @brief Gets the number of items that left the last stage in the last run
+         */
+        uint64_t processed_items() const { return mProcessedItems.load(std::memory_order_relaxed); }
+
+    private:
+        struct stage
+        {
+            stage(pipeline_stage_mode pMode, std::function<void(Item &)> pFunction)
+                : mMode(pMode)
+                , mFunction(std::move(pFunction))
+                , mBusy(false)
+                , mNextSequence(0) {}
+
+            pipeline_stage_mode mMode;
+            std::function<void(Item &)> mFunction;
+
+            // Serial stages only
+            std::mutex mMutex;
+            bool mBusy;
+            uint64_t mNextSequence;               ///< Next item allowed in, serial_in_order only
+            std::map<uint64_t, size_t> mWaiting;  ///< Parked tokens by sequence number
+        };
+
+        void submit_token(size_t pToken, size_t pStage, bool pOwnsStage)
+        {
+            mJobSystem.submit(new job([this, pToken, pStage, pOwnsStage]
+                                      { run_token(pToken, pStage, pOwnsStage); }, mName));
+        }
+
+        /**
+         * @brief Carries an item through the stages starting at pStage, then reads the next ones
+         * @param pOwnsStage The serial stage pStage was already handed to this item
+         */
+        void run_token(size_t pToken, size_t pStage, bool pOwnsStage)
+        {
+            while (true)
+            {
+                if (pStage == 0 && !read_item(pToken))
+                {
+                    return;
+                }
+
+                for (size_t s = pStage; s < mStages.size(); ++s)
+                {
+                    stage &current = *mStages[s];
+                    bool serial = current.mMode != pipeline_stage_mode::parallel;
+                    if (serial && !pOwnsStage && !enter_serial(current, pToken))
+                    {
+                        return;
+                    }
+
+                    current.mFunction(mItems[pToken]);
+                    pOwnsStage = false;
+                    if (serial)
+                    {
+                        leave_serial(current, s);
+                    }
+                }
+
+                mProcessedItems.fetch_add(1, std::memory_order_relaxed);
+                pStage = 0;
+            }
+        }
+
+        /**
+         * @brief Fills the token's item from the source
+         * @return false if the source is busy (the token waits for it) or exhausted (the token is released)
+         */
+        bool read_item(size_t pToken)
+        {
+            // Tokens are released outside the lock, run() may return and destroy it right after
+            {
+                std::unique_lock<std::mutex> lock(mSourceMutex);
+                if (mSourceBusy)
+                {
+                    mFreeTokens.push_back(pToken);
+                    return false;
+                }
+                if (mSourceDone)
+                {
+                    lock.unlock();
+                    release_tokens(1);
+                    return false;
+                }
+                mSourceBusy = true;
+            }
+
+            bool hasItem = mSource(mItems[pToken]);
+
+            size_t waitingToken = 0;
+            bool handOver = false;
+            size_t released = 0;
+            {
+                std::lock_guard<std::mutex> lock(mSourceMutex);
+                mSourceBusy = false;
+                if (hasItem)
+                {
+                    mSequences[pToken] = mNextSequence++;
+                }
+                else
+                {
+                    // Tokens waiting for input will never get any
+                    mSourceDone = true;
+                    released = mFreeTokens.size() + 1;
+                    mFreeTokens.clear();
+                }
+
+                if (!mFreeTokens.empty())
+                {
+                    waitingToken = mFreeTokens.back();
+                    mFreeTokens.pop_back();
+                    handOver = true;
+                }
+            }
+
+            if (handOver)
+            {
+                submit_token(waitingToken, 0, false);
+            }
+            if (released > 0)
+            {
+                release_tokens(released);
+            }
+            return hasItem;
+        }
+
+        /**
+         * @brief Takes a serial stage for a token, or parks the token until it is handed the stage
+         */
+        bool enter_serial(stage &pStage, size_t pToken)
+        {
+            uint64_t sequence = mSequences[pToken];
+            std::lock_guard<std::mutex> lock(pStage.mMutex);
+            bool itsTurn = pStage.mMode == pipeline_stage_mode::serial_any_order || sequence == pStage.mNextSequence;
+            if (pStage.mBusy || !itsTurn)
+            {
+                pStage.mWaiting[sequence] = pToken;
+                return false;
+            }
+            pStage.mBusy = true;
+            return true;
+        }
+
+        /**
+         * @brief Frees a serial stage, handing it to the next parked token that may enter it
+         */
+        void leave_serial(stage &pStage, size_t pStageIndex)
+        {
+            size_t nextToken = 0;
+            bool handOver = false;
+            {
+                std::lock_guard<std::mutex> lock(pStage.mMutex);
+                ++pStage.mNextSequence;
+
+                auto next = pStage.mWaiting.begin();
+                if (next != pStage.mWaiting.end() &&
+                    (pStage.mMode == pipeline_stage_mode::serial_any_order || next->first == pStage.mNextSequence))
+                {
+                    nextToken = next->second;
+                    pStage.mWaiting.erase(next);
+                    handOver = true;
+                }
+                else
+                {
+                    pStage.mBusy = false;
+                }
+            }
+
+            if (handOver)
+            {
+                submit_token(nextToken, pStageIndex, true);
+            }
+        }
+
+        void release_tokens(size_t pCount)
+        {
+            mReleasedTokens.fetch_add(pCount, std::memory_order_release);
+        }
+
+        job_system &mJobSystem;
+        const char* mName;
+        std::vector<Item> mItems;                    ///< One item per token
+        std::vector<uint64_t> mSequences;            ///< Source order of each token's current item
+        std::function<bool(Item &)> mSource;
+        std::vector<std::unique_ptr<stage>> mStages;
+
+        std::mutex mSourceMutex;
+        bool mSourceBusy;
+        bool mSourceDone;
+        uint64_t mNextSequence;
+        std::vector<size_t> mFreeTokens;             ///< Tokens waiting for the source
+
+        std::atomic<size_t> mReleasedTokens;
+        std::atomic<uint64_t> mProcessedItems;
+    };
+
+    } // namespace jobs
+} // namespace cacau
@@ -0,0 +1,79 @@
+#include "scratch_arena.h"
+#include <cstdint>
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    scratch_arena::scratch_arena(size_t pBlockSize)
+        : mBlockSize(pBlockSize)
+        , mBlocks()
+        , mCurrentBlock(0)
+        , mOffset(0)
+    {
+    }
+
+    scratch_arena::~scratch_arena()
+    {
+        for (auto &arenaBlock : mBlocks)
+        {
+            ::operator delete(arenaBlock.mData);
+        }
+    }
+
+    void* scratch_arena::allocate(size_t pSize, size_t pAlignment)
+    {
+        // Try the current block, then the following (already allocated) ones
+        while (mCurrentBlock < mBlocks.size())
+        {
+            block &current = mBlocks[mCurrentBlock];
+            uintptr_t base = reinterpret_cast<uintptr_t>(current.mData);
+            uintptr_t aligned = (base + mOffset + pAlignment - 1) & ~(uintptr_t(pAlignment) - 1);
+            size_t end = static_cast<size_t>(aligned - base) + pSize;
+            if (end <= current.mSize)
+            {
+                mOffset = end;
+                return reinterpret_cast<void*>(aligned);
+            }
+
+            ++mCurrentBlock;
+            mOffset = 0;
+        }
+
+        // Out of blocks, oversized requests get a block of their own
+        size_t size = pSize + pAlignment > mBlockSize ? pSize + pAlignment : mBlockSize;
+        mBlocks.push_back(block{static_cast<char*>(::operator new(size)), size});
+        mCurrentBlock = mBlocks.size() - 1;
+        mOffset = 0;
+        return allocate(pSize, pAlignment);
+    }
+
+    void scratch_arena::rewind(const marker_type &pMarker)
+    {
+        mCurrentBlock = pMarker.mBlock;
+        mOffset = pMarker.mOffset;
+    }
+
+    size_t scratch_arena::used() const
+    {
+        size_t total = mOffset;
+        for (size_t i = 0; i < mCurrentBlock && i < mBlocks.size(); ++i)
+        {
+            total += mBlocks[i].mSize;
+        }
+        return total;
+    }
+
+    size_t scratch_arena::capacity() const
+    {
+        size_t total = 0;
+        for (const auto &arenaBlock : mBlocks)
+        {
+            total += arenaBlock.mSize;
+        }
+        return total;
+    }
+
+    } // namespace jobs
+} // namespace cacau
@@ -0,0 +1,107 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    /**
+     * @brief Bump allocator for short-lived temporary buffers
+     * @details Allocation advances a pointer inside the current block, freeing happens all at
+     *          once with reset() or rewind(). Blocks are kept across resets, so a warmed-up arena
+     *          does not touch the global allocator. Not thread-safe: every worker owns its arenas.
+     *          Destructors of objects placed in the arena are never run
+     */
+    class scratch_arena
+    {
+    public:
+        /**
+         * @brief Position in the arena, returned by marker() and accepted by rewind()
+         */
+        struct marker_type
+        {
+            size_t mBlock;
+            size_t mOffset;
+        };
+
+        /**
+         * @param pBlockSize Size of each block requested from the heap, larger requests get their own block
+         */
+        explicit scratch_arena(size_t pBlockSize = 64 * 1024);
+        ~scratch_arena();
+
+        scratch_arena(const scratch_arena &) = delete;
+        scratch_arena &operator=(const scratch_arena &) = delete;
+
+        /**
+         * @brief Allocates uninitialized memory
+         * @param pSize Number of bytes
+         * @param pAlignment Power of two alignment
+         */
+        void* allocate(size_t pSize, size_t pAlignment = alignof(std::max_align_t));
+
+        /**
+         * @brief Allocates an uninitialized array of trivially destructible elements
+         */
+        template <typename T>
+        T* allocate_array(size_t pCount)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed");
+            return static_cast<T*>(allocate(sizeof(T) * pCount, alignof(T)));
+        }
+
+        /**
+         * @brief Constructs a trivially destructible object in the arena
+         */
+        template <typename T, typename... Args>
+        T* create(Args&&... pArgs)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed");
+            return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(pArgs)...);
+        }
+
+        /**
+         * @brief Gets the current position, to free everything allocated after it with rewind()
+         */
+        marker_type marker() const { return marker_type{mCurrentBlock, mOffset}; }
+
+        /**
+         * @brief Frees everything allocated after pMarker
+         */
+        void rewind(const marker_type &pMarker);
+
+        /**
+         * @brief Frees everything, blocks are kept for reuse
+         */
+        void reset() { rewind(marker_type{0, 0}); }
+
+        /**
+         * @brief Gets the number of bytes handed out since the last reset, including alignment padding
+         */
+        size_t used() const;
+
+        /**
+         * @brief Gets the total size of all blocks owned by the arena
+         */
+        size_t capacity() const;
+
+    private:
+        struct block
+        {
+            char* mData;
+            size_t mSize;
+        };
+
+        size_t mBlockSize;
+        std::vector<block> mBlocks;
+        size_t mCurrentBlock;
+        size_t mOffset;
+    };
+
+    } // namespace jobs
+} // namespace cacau
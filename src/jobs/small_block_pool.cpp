@@ -0,0 +1,153 @@
+#include "small_block_pool.h"
+#include <new>
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    namespace
+    {
+        constexpr size_t kHeaderSize = 16;
+        constexpr size_t kSlabSize = 16 * 1024;
+        constexpr size_t kHeapSizeClass = ~size_t(0);
+
+        size_t size_class(size_t pSize)
+        {
+            size_t sizeClass = 0;
+            size_t blockSize = small_block_pool::kMinBlockSize;
+            while (blockSize < pSize)
+            {
+                blockSize <<= 1;
+                ++sizeClass;
+            }
+            return sizeClass;
+        }
+
+        size_t block_size(size_t pSizeClass)
+        {
+            return small_block_pool::kMinBlockSize << pSizeClass;
+        }
+    }
+
+    small_block_pool::small_block_pool()
+        : mRemoteFrees(nullptr)
+        , mSlabs()
+        , mReservedBytes(0)
+    {
+        for (auto &freeList : mFreeLists)
+        {
+            freeList = nullptr;
+        }
+    }
+
+    small_block_pool::~small_block_pool()
+    {
+        for (char *slab : mSlabs)
+        {
+            ::operator delete(slab);
+        }
+    }
+
+    void* small_block_pool::allocate(small_block_pool *pPool, size_t pSize)
+    {
+        static_assert(sizeof(block_header) <= kHeaderSize, "Block header must fit before the payload");
+
+        if (pPool != nullptr && pSize <= kMaxBlockSize)
+        {
+            return pPool->allocate_local(size_class(pSize));
+        }
+
+        block_header *header = static_cast<block_header *>(::operator new(kHeaderSize + pSize));
+        header->mOwner = nullptr;
+        header->mSizeClass = kHeapSizeClass;
+        return reinterpret_cast<char *>(header) + kHeaderSize;
+    }
+
+    void small_block_pool::deallocate(small_block_pool *pLocalPool, void* pBlock)
+    {
+        if (pBlock == nullptr)
+        {
+            return;
+        }
+
+        free_block *block = reinterpret_cast<free_block *>(static_cast<char *>(pBlock) - kHeaderSize);
+        small_block_pool *owner = block->mHeader.mOwner;
+        if (owner == nullptr)
+        {
+            ::operator delete(block);
+        }
+        else if (owner == pLocalPool)
+        {
+            owner->free_local(block);
+        }
+        else
+        {
+            owner->free_remote(block);
+        }
+    }
+
+    void* small_block_pool::allocate_local(size_t pSizeClass)
+    {
+        if (mFreeLists[pSizeClass] == nullptr)
+        {
+            drain_remote_frees();
+            if (mFreeLists[pSizeClass] == nullptr)
+            {
+                carve_slab(pSizeClass);
+            }
+        }
+
+        free_block *block = mFreeLists[pSizeClass];
+        mFreeLists[pSizeClass] = block->mNext;
+        return reinterpret_cast<char *>(block) + kHeaderSize;
+    }
+
+    void small_block_pool::free_local(free_block *pBlock)
+    {
+        size_t sizeClass = pBlock->mHeader.mSizeClass;
+        pBlock->mNext = mFreeLists[sizeClass];
+        mFreeLists[sizeClass] = pBlock;
+    }
+
+    void small_block_pool::free_remote(free_block *pBlock)
+    {
+        // Multiple producers push, the single consumer takes the whole stack at once, so there is no ABA
+        free_block *head = mRemoteFrees.load(std::memory_order_relaxed);
+        do
+        {
+            pBlock->mNext = head;
+        } while (!mRemoteFrees.compare_exchange_weak(head, pBlock, std::memory_order_release,
+                                                     std::memory_order_relaxed));
+    }
+
+    void small_block_pool::drain_remote_frees()
+    {
+        free_block *block = mRemoteFrees.exchange(nullptr, std::memory_order_acquire);
+        while (block != nullptr)
+        {
+            free_block *next = block->mNext;
+            free_local(block);
+            block = next;
+        }
+    }
+
+    void small_block_pool::carve_slab(size_t pSizeClass)
+    {
+        size_t stride = kHeaderSize + block_size(pSizeClass);
+        size_t count = kSlabSize / stride > 0 ? kSlabSize / stride : 1;
+        char *slab = static_cast<char *>(::operator new(stride * count));
+        mSlabs.push_back(slab);
+        mReservedBytes += stride * count;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            free_block *block = reinterpret_cast<free_block *>(slab + i * stride);
+            block->mHeader.mOwner = this;
+            block->mHeader.mSizeClass = pSizeClass;
+            free_local(block);
+        }
+    }
+
+    } // namespace jobs
+} // namespace cacau
@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    /**
+     * @brief Lock-free fixed-size block allocator owned by one worker
+     * @details Requests are rounded up to a power-of-two size class (16 to 2048 bytes), larger
+     *          ones go to the heap. The owner allocates and frees through plain free lists.
+     *          Other threads free by pushing onto an atomic stack that the owner drains when a
+     *          free list runs dry, so no path ever takes a lock. Every block carries a small
+     *          header naming its pool, so any block may be freed from any thread while the
+     *          pool is alive
+     */
+    class small_block_pool
+    {
+    public:
+        static constexpr size_t kMinBlockSize = 16;
+        static constexpr size_t kMaxBlockSize = 2048;
+        static constexpr size_t kClassCount = 8;
+
+        small_block_pool();
+        ~small_block_pool();
+
+        small_block_pool(const small_block_pool &) = delete;
+        small_block_pool &operator=(const small_block_pool &) = delete;
+
+        /**
+         * @brief Allocates a block of at least pSize bytes, must be called by the owning thread
+         * @param pPool Owning pool, or nullptr to allocate from the heap
+         */
+        static void* allocate(small_block_pool *pPool, size_t pSize);
+
+        /**
+         * @brief Frees a block returned by allocate() from any thread
+         * @param pLocalPool Pool owned by the calling thread, or nullptr
+         */
+        static void deallocate(small_block_pool *pLocalPool, void* pBlock);
+
+        /**
+         * @brief Gets the number of bytes reserved from the heap for blocks
+         */
+        size_t reserved_bytes() const { return mReservedBytes; }
+
+    private:
+        // Padded to 16 bytes on 32-bit targets too, so payloads stay 16-byte aligned
+        struct alignas(16) block_header
+        {
+            small_block_pool *mOwner;
+            size_t mSizeClass;
+        };
+
+        struct free_block
+        {
+            block_header mHeader;
+            free_block *mNext;
+        };
+
+        void* allocate_local(size_t pSizeClass);
+        void free_local(free_block *pBlock);
+        void free_remote(free_block *pBlock);
+        void drain_remote_frees();
+        void carve_slab(size_t pSizeClass);
+
+        free_block *mFreeLists[kClassCount];
+        std::atomic<free_block *> mRemoteFrees;
+        std::vector<char *> mSlabs;
+        size_t mReservedBytes;
+    };
+
+    } // namespace jobs
+} // namespace cacau
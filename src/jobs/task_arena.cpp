@@ -0,0 +1,71 @@
+#include "task_arena.h"
+#include <mutex>
+#include "job_system.h"
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    task_arena::task_arena(job_system &pJobSystem, size_t pMaxConcurrency, uint32_t pWeight, const char* pName)
+        : mJobSystem(pJobSystem)
+        , mName(pName)
+        , mMaxConcurrency(pMaxConcurrency > 0 ? pMaxConcurrency : pJobSystem.thread_count())
+        , mWeight(pWeight > 0 ? pWeight : 1)
+    {
+        mJobSystem.register_arena(this);
+    }
+
+    task_arena::~task_arena()
+    {
+        wait_for_all_jobs();
+        mJobSystem.unregister_arena(this);
+    }
+
+    void task_arena::submit(job* pNewJob)
+    {
+        mJobSystem.push_arena_job(this, pNewJob);
+    }
+
+    void task_arena::wait_for_all_jobs()
+    {
+        mJobSystem.wait_for_arena(this);
+    }
+
+    void task_arena::set_max_concurrency(size_t pMaxConcurrency)
+    {
+        std::lock_guard<std::mutex> lock(mJobSystem.mArenaMutex);
+        mMaxConcurrency = pMaxConcurrency > 0 ? pMaxConcurrency : mJobSystem.thread_count();
+    }
+
+    size_t task_arena::max_concurrency() const
+    {
+        std::lock_guard<std::mutex> lock(mJobSystem.mArenaMutex);
+        return mMaxConcurrency;
+    }
+
+    void task_arena::set_weight(uint32_t pWeight)
+    {
+        std::lock_guard<std::mutex> lock(mJobSystem.mArenaMutex);
+        mWeight = pWeight > 0 ? pWeight : 1;
+    }
+
+    uint32_t task_arena::weight() const
+    {
+        std::lock_guard<std::mutex> lock(mJobSystem.mArenaMutex);
+        return mWeight;
+    }
+
+    size_t task_arena::get_pending_jobs() const
+    {
+        std::lock_guard<std::mutex> lock(mJobSystem.mArenaMutex);
+        return mQueue.size();
+    }
+
+    size_t task_arena::get_running_jobs() const
+    {
+        return mRunning.load(std::memory_order_relaxed);
+    }
+
+    } // namespace jobs
+} // namespace cacau
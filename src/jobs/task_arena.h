@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include "job.h"
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    class job_system;
+
+    /**
+     * @brief Isolated set of jobs run by the workers of a shared job system
+     * @details Lets several subsystems share one worker pool instead of each creating its own
+     *          job system and oversubscribing the cores. Every arena has its own queue, a limit
+     *          on how many of its jobs run at once and a weight. Workers alternate between the
+     *          job system's own queues and the arenas, and among the arenas with runnable jobs
+     *          each gets turns in proportion to its weight, so a burst in one arena cannot
+     *          starve the others. Jobs submitted from inside an arena job go to the job
+     *          system's queues unless they are submitted to an arena.
+     *          All arenas of a job system share one lock, taken to queue and to pick an arena
+     *          job. Workers skip it while no arena job is queued, but with many workers and
+     *          very short arena jobs it becomes the bottleneck: batch such work into fewer jobs.
+     *          The arena must be destroyed before its job system
+     */
+    class task_arena
+    {
+    public:
+        /**
+         * @param pJobSystem Job system whose workers run the arena's jobs
+         * @param pMaxConcurrency Maximum number of the arena's jobs running at once, 0 for the thread count
+         * @param pWeight Share of the workers' turns relative to the other arenas, at least 1
+         * @param pName Name of the arena (used in logging)
+         */
+        task_arena(job_system &pJobSystem, size_t pMaxConcurrency = 0, uint32_t pWeight = 1, const char* pName = "Arena");
+
+        /**
+         * @brief Waits for the arena's jobs, then detaches it from the job system
+         */
+        ~task_arena();
+
+        task_arena(const task_arena &) = delete;
+        task_arena &operator=(const task_arena &) = delete;
+
+        /**
+         * @brief Submits a job to the arena's queue, it is deleted after it runs
+         */
+        void submit(job* pNewJob);
+
+        /**
+         * @brief Blocks until every job submitted to the arena has completed
+         * @details Never runs jobs of another arena or of the job system's queues. Called from
+         *          a worker, the worker runs the arena's queued jobs while waiting. Called from
+         *          inside one of the arena's own jobs, it waits for every other job and lends the
+         *          calling job's slot, so nested waits finish even at the concurrency limit.
+         *          Two jobs of the same arena must not wait on it at once, they would wait for
+         *          each other. Called from any other thread it only yields, so the pool is not
+         *          oversubscribed
+         */
+        void wait_for_all_jobs();
+
+        /**
+         * @brief Changes the concurrency limit, jobs already running are not interrupted
+         * @param pMaxConcurrency Maximum number of jobs running at once, 0 for the thread count
+         */
+        void set_max_concurrency(size_t pMaxConcurrency);
+        size_t max_concurrency() const;
+
+        /**
+         * @brief Changes the share of turns the arena gets, at least 1
+         */
+        void set_weight(uint32_t pWeight);
+        uint32_t weight() const;
+
+        /**
+         * @brief Gets the number of queued jobs not started yet
+         */
+        size_t get_pending_jobs() const;
+
+        /**
+         * @brief Gets the number of the arena's jobs running now
+         */
+        size_t get_running_jobs() const;
+
+        /**
+         * @brief Gets the number of the arena's jobs completed since creation
+         */
+        uint64_t completed_jobs() const { return mCompletedJobs.load(std::memory_order_relaxed); }
+
+        const char* name() const { return mName; }
+        job_system &get_job_system() const { return mJobSystem; }
+
+    private:
+        friend class job_system;
+
+        job_system &mJobSystem;
+        const char* mName;
+
+        // Guarded by the job system's arena mutex
+        std::deque<job *> mQueue;
+        size_t mMaxConcurrency;
+        uint32_t mWeight;
+        uint64_t mPass = 0;   ///< Virtual time of the arena's next turn, advances by kArenaStride / weight
+
+        std::atomic<size_t> mRunning{0};  ///< Raised under the arena mutex when a job is taken, lowered without it
+        std::atomic<uint64_t> mSubmittedJobs{0};
+        std::atomic<uint64_t> mCompletedJobs{0};
+    };
+
+    } // namespace jobs
+} // namespace cacau
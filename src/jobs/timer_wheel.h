@@ -0,0 +1,295 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace cacau
+{
+    namespace jobs
+    {
+
+    /**
+     * @brief Hierarchical timer wheel keyed by integer ticks
+     * @details Four levels of 64 slots cover 64^4 ticks ahead of the current tick, timers further
+     *          away wait in an overflow list. Level 0 holds timers due in the next 64 ticks, one
+     *          slot per tick. Every 64^L ticks the current slot of level L is cascaded: its timers
+     *          are re-inserted into the lower levels. Scheduling is O(1), advancing is O(1) per
+     *          tick plus the cascaded timers, and ticks are skipped 64 at a time while level 0
+     *          is empty. Not thread-safe
+     * @tparam Payload Value stored with each timer, handed back when it expires
+     */
+    template <typename Payload>
+    class timer_wheel
+    {
+    public:
+        static constexpr size_t kLevels = 4;
+        static constexpr size_t kSlotBits = 6;
+        static constexpr size_t kSlots = size_t(1) << kSlotBits;
+
+        timer_wheel()
+            : mCurrentTick(0)
+            , mSize(0)
+        {
+            for (auto &count : mLevelCounts)
+            {
+                count = 0;
+            }
+        }
+
+        /**
+         * @brief Gets the tick the wheel advanced to
+         */
+        uint64_t current_tick() const { return mCurrentTick; }
+
+        /**
+         * @brief Gets the number of timers not expired yet
+         */
+        size_t size() const { return mSize; }
+
+        bool empty() const { return mSize == 0; }
+
+        /**
+         * @brief Adds a timer, one due at or before the current tick expires on the next advance()
+         */
+        void schedule(uint64_t pExpiryTick, Payload pPayload)
+        {
+            ++mSize;
+            place(entry{pExpiryTick, std::move(pPayload)});
+        }
+
+        /**
+         * @brief Advances to pTick, calling pExpired(expiryTick, payload) for every timer due by then
+         * @details Timers are reported in expiry order, except that timers already due when
+         *          scheduled come first. pExpired must not schedule into this wheel
+         */
+        template <typename Callback>
+        void advance(uint64_t pTick, Callback pExpired)
+        {
+            if (!mDue.empty())
+            {
+                std::vector<entry> due;
+                due.swap(mDue);
+                expire(due, pExpired);
+            }
+
+            while (mCurrentTick < pTick)
+            {
+                if (mSize == 0)
+                {
+                    mCurrentTick = pTick;
+                    break;
+                }
+
+                // Nothing can fire before level 0 wraps, jump to the last tick before it
+                if (mLevelCounts[0] == 0)
+                {
+                    uint64_t blockEnd = mCurrentTick | (kSlots - 1);
+                    if (blockEnd > mCurrentTick)
+                    {
+                        mCurrentTick = blockEnd < pTick ? blockEnd : pTick;
+                        continue;
+                    }
+                }
+
+                ++mCurrentTick;
+                cascade();
+
+                // Cascaded timers expiring right now
+                if (!mDue.empty())
+                {
+                    std::vector<entry> due;
+                    due.swap(mDue);
+                    expire(due, pExpired);
+                }
+
+                std::vector<entry> &slot = mSlots[0][mCurrentTick & (kSlots - 1)];
+                if (!slot.empty())
+                {
+                    std::vector<entry> due;
+                    due.swap(slot);
+                    mLevelCounts[0] -= due.size();
+                    expire(due, pExpired);
+                }
+            }
+        }
+
+        /**
+         * @brief Gets the earliest tick at which advance() may expire a timer
+         * @details Exact for timers in the next 64 ticks, otherwise the tick at which the
+         *          timer's slot is cascaded, which is never later than its expiry
+         * @return false if the wheel is empty
+         */
+        bool next_expiry(uint64_t &pTick) const
+        {
+            if (mSize == 0)
+            {
+                return false;
+            }
+            if (!mDue.empty())
+            {
+                pTick = mCurrentTick;
+                return true;
+            }
+
+            // Level 0 is exact, higher levels and the overflow list give the tick their next
+            // timers are cascaded at, the earliest of all is taken
+            uint64_t earliest = ~uint64_t(0);
+            if (mLevelCounts[0] > 0)
+            {
+                for (uint64_t tick = mCurrentTick + 1; tick <= mCurrentTick + kSlots; ++tick)
+                {
+                    if (!mSlots[0][tick & (kSlots - 1)].empty())
+                    {
+                        earliest = tick;
+                        break;
+                    }
+                }
+            }
+
+            for (size_t level = 1; level < kLevels; ++level)
+            {
+                if (mLevelCounts[level] == 0)
+                {
+                    continue;
+                }
+
+                size_t shift = level * kSlotBits;
+                uint64_t block = mCurrentTick >> shift;
+                for (uint64_t next = block + 1; next <= block + kSlots; ++next)
+                {
+                    if (!mSlots[level][next & (kSlots - 1)].empty())
+                    {
+                        earliest = std::min(earliest, next << shift);
+                        break;
+                    }
+                }
+            }
+
+            if (!mOverflow.empty())
+            {
+                size_t shift = kLevels * kSlotBits;
+                earliest = std::min(earliest, ((mCurrentTick >> shift) + 1) << shift);
+            }
+
+            pTick = earliest;
+            return true;
+        }
+
+        /**
+         * @brief Removes every timer, calling pVisit(payload) on each
+         */
+        template <typename Callback>
+        void clear(Callback pVisit)
+        {
+            auto visitAll = [&pVisit](std::vector<entry> &pEntries)
+            {
+                for (auto &current : pEntries)
+                {
+                    pVisit(current.mPayload);
+                }
+                pEntries.clear();
+            };
+
+            visitAll(mDue);
+            visitAll(mOverflow);
+            for (size_t level = 0; level < kLevels; ++level)
+            {
+                for (auto &slot : mSlots[level])
+                {
+                    visitAll(slot);
+                }
+                mLevelCounts[level] = 0;
+            }
+            mSize = 0;
+        }
+
+    private:
+        struct entry
+        {
+            uint64_t mExpiry;
+            Payload mPayload;
+        };
+
+        void place(entry &&pEntry)
+        {
+            if (pEntry.mExpiry <= mCurrentTick)
+            {
+                mDue.push_back(std::move(pEntry));
+                return;
+            }
+
+            uint64_t delta = pEntry.mExpiry - mCurrentTick;
+            for (size_t level = 0; level < kLevels; ++level)
+            {
+                size_t shift = level * kSlotBits;
+                if (delta < (uint64_t(1) << (shift + kSlotBits)))
+                {
+                    mSlots[level][(pEntry.mExpiry >> shift) & (kSlots - 1)].push_back(std::move(pEntry));
+                    ++mLevelCounts[level];
+                    return;
+                }
+            }
+            mOverflow.push_back(std::move(pEntry));
+        }
+
+        /**
+         * @brief Re-inserts the timers of every level whose current slot starts at this tick, top down
+         */
+        void cascade()
+        {
+            if ((mCurrentTick & ((uint64_t(1) << (kLevels * kSlotBits)) - 1)) == 0 && !mOverflow.empty())
+            {
+                std::vector<entry> overflow;
+                overflow.swap(mOverflow);
+                for (auto &current : overflow)
+                {
+                    place(std::move(current));
+                }
+            }
+
+            for (size_t level = kLevels - 1; level > 0; --level)
+            {
+                size_t shift = level * kSlotBits;
+                if ((mCurrentTick & ((uint64_t(1) << shift) - 1)) != 0)
+                {
+                    continue;
+                }
+
+                std::vector<entry> &slot = mSlots[level][(mCurrentTick >> shift) & (kSlots - 1)];
+                if (slot.empty())
+                {
+                    continue;
+                }
+
+                std::vector<entry> moved;
+                moved.swap(slot);
+                mLevelCounts[level] -= moved.size();
+                for (auto &current : moved)
+                {
+                    place(std::move(current));
+                }
+            }
+        }
+
+        template <typename Callback>
+        void expire(std::vector<entry> &pEntries, Callback &pExpired)
+        {
+            mSize -= pEntries.size();
+            for (auto &current : pEntries)
+            {
+                pExpired(current.mExpiry, current.mPayload);
+            }
+        }
+
+        uint64_t mCurrentTick;
+        size_t mSize;
+        size_t mLevelCounts[kLevels];
+        std::vector<entry> mSlots[kLevels][kSlots];
+        std::vector<entry> mOverflow;
+        std::vector<entry> mDue;  ///< Scheduled at or before the current tick
+    };
+
+    } // namespace jobs
+} // namespace cacau
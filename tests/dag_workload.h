@@ -0,0 +1,407 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "cacau_jobs.h"
+#include "test_util.h"
+
+/**
+ * @brief Synthetic job graph generator and execution harness
+ * @details Generates layered, fork-join, random and chain shaped DAGs, runs them
+ *          through submit_with_dependencies and compares the measured makespan
+ *          against the theoretical lower bound max(critical path, work / P)
+ */
+namespace dag_workload
+{
+    enum class dag_shape
+    {
+        layered,    ///< depth layers of width jobs, edges only between adjacent layers
+        fork_join,  ///< depth stages of fork -> width jobs -> join
+        random,     ///< width * depth jobs, edge i -> j (i < j) with probability edge_density
+        chain       ///< width independent chains of depth jobs each
+    };
+
+    enum class cost_distribution
+    {
+        constant,     ///< every job costs mean_cost
+        uniform,      ///< uniform in [0, 2 * mean_cost]
+        exponential,  ///< exponential with mean mean_cost (many small, few large jobs)
+        bimodal       ///< 90% cheap jobs, 10% jobs ten times more expensive
+    };
+
+    struct dag_params
+    {
+        dag_shape shape = dag_shape::layered;
+        size_t width = 8;
+        size_t depth = 8;
+        double edge_density = 0.5;
+        cost_distribution costs = cost_distribution::constant;
+        uint32_t mean_cost = 200;  ///< In work units, see burn_work()
+        uint32_t seed = 1;
+    };
+
+    struct dag_node
+    {
+        std::vector<size_t> dependencies;  ///< Always lower indices, so node order is topological
+        uint32_t cost = 0;
+    };
+
+    struct dag_graph
+    {
+        std::vector<dag_node> nodes;
+        size_t edge_count = 0;
+    };
+
+    struct dag_report
+    {
+        size_t jobs = 0;
+        size_t edges = 0;
+        double makespan_ms = 0.0;
+        double total_work_ms = 0.0;      ///< Sum of measured job run times
+        double critical_path_ms = 0.0;   ///< Longest measured path through the graph
+        double lower_bound_ms = 0.0;     ///< max(critical path, total work / P)
+        double efficiency = 0.0;         ///< lower bound / makespan, 1.0 is a perfect schedule
+        bool completed = false;
+        bool valid = false;              ///< Every job ran exactly once, after all its dependencies
+    };
+
+    inline const char* shape_name(dag_shape pShape)
+    {
+        switch (pShape)
+        {
+        case dag_shape::layered: return "layered";
+        case dag_shape::fork_join: return "fork_join";
+        case dag_shape::random: return "random";
+        case dag_shape::chain: return "chain";
+        }
+        return "unknown";
+    }
+
+    inline const char* cost_name(cost_distribution pCosts)
+    {
+        switch (pCosts)
+        {
+        case cost_distribution::constant: return "constant";
+        case cost_distribution::uniform: return "uniform";
+        case cost_distribution::exponential: return "exponential";
+        case cost_distribution::bimodal: return "bimodal";
+        }
+        return "unknown";
+    }
+
+    /**
+     * @brief Burns CPU for pUnits work units (one unit is ~100 multiply-adds)
+     */
+    inline void burn_work(uint32_t pUnits)
+    {
+        test_util::spin(pUnits * 100u);
+    }
+
+    inline uint32_t sample_cost(const dag_params &pParams, std::mt19937 &pRng)
+    {
+        double mean = static_cast<double>(pParams.mean_cost);
+        switch (pParams.costs)
+        {
+        case cost_distribution::constant:
+            return pParams.mean_cost;
+        case cost_distribution::uniform:
+            return static_cast<uint32_t>(std::uniform_real_distribution<double>(0.0, 2.0 * mean)(pRng));
+        case cost_distribution::exponential:
+            return static_cast<uint32_t>(std::exponential_distribution<double>(1.0 / std::max(mean, 1.0))(pRng));
+        case cost_distribution::bimodal:
+            return std::bernoulli_distribution(0.1)(pRng)
+                ? static_cast<uint32_t>(mean * 10.0 / 1.9)
+                : static_cast<uint32_t>(mean / 1.9);
+        }
+        return pParams.mean_cost;
+    }
+
+    /**
+     * @brief Generates a DAG whose node indices are already in topological order
+     */
+    inline dag_graph generate_dag(const dag_params &pParams)
+    {
+        std::mt19937 rng(pParams.seed);
+        std::bernoulli_distribution edge(std::min(std::max(pParams.edge_density, 0.0), 1.0));
+        size_t width = std::max<size_t>(pParams.width, 1);
+        size_t depth = std::max<size_t>(pParams.depth, 1);
+        dag_graph graph;
+
+        switch (pParams.shape)
+        {
+        case dag_shape::layered:
+            graph.nodes.resize(width * depth);
+            for (size_t layer = 1; layer < depth; ++layer)
+            {
+                for (size_t i = 0; i < width; ++i)
+                {
+                    auto &deps = graph.nodes[layer * width + i].dependencies;
+                    for (size_t j = 0; j < width; ++j)
+                    {
+                        if (edge(rng))
+                        {
+                            deps.push_back((layer - 1) * width + j);
+                        }
+                    }
+                    // Keep every layer connected to the previous one
+                    if (deps.empty())
+                    {
+                        deps.push_back((layer - 1) * width + rng() % width);
+                    }
+                }
+            }
+            break;
+
+        case dag_shape::fork_join:
+        {
+            // Stage layout: [join of previous stage] -> width jobs -> join
+            graph.nodes.resize(1);
+            size_t fork = 0;
+            for (size_t stage = 0; stage < depth; ++stage)
+            {
+                size_t first = graph.nodes.size();
+                for (size_t i = 0; i < width; ++i)
+                {
+                    dag_node node;
+                    node.dependencies.push_back(fork);
+                    graph.nodes.push_back(node);
+                }
+                dag_node join;
+                for (size_t i = 0; i < width; ++i)
+                {
+                    join.dependencies.push_back(first + i);
+                }
+                graph.nodes.push_back(join);
+                fork = graph.nodes.size() - 1;
+            }
+            break;
+        }
+
+        case dag_shape::random:
+            graph.nodes.resize(width * depth);
+            for (size_t j = 1; j < graph.nodes.size(); ++j)
+            {
+                for (size_t i = 0; i < j; ++i)
+                {
+                    if (edge(rng))
+                    {
+                        graph.nodes[j].dependencies.push_back(i);
+                    }
+                }
+            }
+            break;
+
+        case dag_shape::chain:
+            graph.nodes.resize(width * depth);
+            for (size_t c = 0; c < width; ++c)
+            {
+                for (size_t i = 1; i < depth; ++i)
+                {
+                    graph.nodes[c * depth + i].dependencies.push_back(c * depth + i - 1);
+                }
+            }
+            break;
+        }
+
+        for (auto &node : graph.nodes)
+        {
+            node.cost = sample_cost(pParams, rng);
+            graph.edge_count += node.dependencies.size();
+        }
+        return graph;
+    }
+
+    /**
+     * @brief Runs a graph on an existing job system and measures it against the lower bound
+     * @param pJobSystem Job system to run on, it is paused while the graph is submitted
+     * @param pGraph Graph produced by generate_dag
+     * @param pThreadCount Number of worker threads of pJobSystem (P)
+     * @param pTimeout Gives up and reports an incomplete run after this long
+     */
+    inline dag_report run_dag(cacau::jobs::job_system &pJobSystem, const dag_graph &pGraph, size_t pThreadCount,
+                              std::chrono::milliseconds pTimeout = std::chrono::milliseconds(60000))
+    {
+        using clock = std::chrono::high_resolution_clock;
+
+        struct node_record
+        {
+            std::atomic<int> runs{0};
+            std::atomic<uint64_t> startSequence{0};
+            std::atomic<uint64_t> finishSequence{0};
+            double startMs = 0.0;
+            double endMs = 0.0;
+        };
+
+        const size_t count = pGraph.nodes.size();
+        std::vector<node_record> records(count);
+        std::atomic<uint64_t> sequence{1};
+        std::atomic<size_t> done{0};
+        std::vector<cacau::jobs::job *> dependentJobs;
+        clock::time_point origin;
+
+        dag_report report;
+        report.jobs = count;
+        report.edges = pGraph.edge_count;
+
+        pJobSystem.pause();
+
+        std::vector<cacau::jobs::job *> jobs(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            node_record *record = &records[i];
+            uint32_t cost = pGraph.nodes[i].cost;
+            jobs[i] = new cacau::jobs::job([record, cost, &sequence, &done, &origin]
+            {
+                record->startSequence = sequence.fetch_add(1);
+                record->startMs = std::chrono::duration<double, std::milli>(clock::now() - origin).count();
+                record->runs.fetch_add(1);
+                burn_work(cost);
+                record->endMs = std::chrono::duration<double, std::milli>(clock::now() - origin).count();
+                record->finishSequence = sequence.fetch_add(1);
+                done.fetch_add(1);
+            }, "DagJob");
+        }
+
+        // Submit in reverse topological order so every job is registered as a
+        // dependant before any of its dependencies can run
+        for (size_t i = count; i-- > 0;)
+        {
+            std::vector<cacau::jobs::job *> dependencies;
+            for (size_t dependency : pGraph.nodes[i].dependencies)
+            {
+                dependencies.push_back(jobs[dependency]);
+            }
+            if (dependencies.empty())
+            {
+                pJobSystem.submit(jobs[i]);
+            }
+            else
+            {
+                pJobSystem.submit_with_dependencies(jobs[i], dependencies);
+                dependentJobs.push_back(jobs[i]);
+            }
+        }
+
+        origin = clock::now();
+        pJobSystem.resume();
+
+        auto deadline = origin + pTimeout;
+        while (done.load() < count && clock::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+        report.makespan_ms = std::chrono::duration<double, std::milli>(clock::now() - origin).count();
+        report.completed = done.load() == count;
+
+        // Jobs submitted with dependencies are not deleted by the job system.
+        // On timeout they are leaked, workers may still reference them
+        if (report.completed)
+        {
+            pJobSystem.wait_for_all_jobs();
+            for (auto *dependentJob : dependentJobs)
+            {
+                delete dependentJob;
+            }
+        }
+
+        // Exactly-once and ordering checks
+        report.valid = report.completed;
+        for (size_t i = 0; i < count && report.valid; ++i)
+        {
+            if (records[i].runs.load() != 1)
+            {
+                report.valid = false;
+                break;
+            }
+            for (size_t dependency : pGraph.nodes[i].dependencies)
+            {
+                if (records[dependency].finishSequence.load() >= records[i].startSequence.load())
+                {
+                    report.valid = false;
+                    break;
+                }
+            }
+        }
+
+        // Lower bound from the measured run times
+        std::vector<double> finishAlongPath(count, 0.0);
+        for (size_t i = 0; i < count; ++i)
+        {
+            double duration = records[i].endMs - records[i].startMs;
+            double longestDependency = 0.0;
+            for (size_t dependency : pGraph.nodes[i].dependencies)
+            {
+                longestDependency = std::max(longestDependency, finishAlongPath[dependency]);
+            }
+            finishAlongPath[i] = longestDependency + duration;
+            report.total_work_ms += duration;
+            report.critical_path_ms = std::max(report.critical_path_ms, finishAlongPath[i]);
+        }
+        report.lower_bound_ms = std::max(report.critical_path_ms,
+                                         report.total_work_ms / static_cast<double>(std::max<size_t>(pThreadCount, 1)));
+        report.efficiency = report.makespan_ms > 0.0 ? report.lower_bound_ms / report.makespan_ms : 0.0;
+
+        return report;
+    }
+
+    /**
+     * @brief Runs a graph on a fresh job system
+     * @param pMode Scheduling mode, critical_path runs the graph once beforehand to collect history
+     */
+    inline dag_report run_dag(const dag_graph &pGraph, size_t pThreadCount,
+                              cacau::jobs::scheduling_mode pMode = cacau::jobs::scheduling_mode::fifo,
+                              std::chrono::milliseconds pTimeout = std::chrono::milliseconds(60000))
+    {
+        cacau::jobs::job_system jobSystem(pThreadCount);
+        jobSystem.set_scheduling_mode(pMode);
+        if (pMode == cacau::jobs::scheduling_mode::critical_path)
+        {
+            dag_report warmUp = run_dag(jobSystem, pGraph, pThreadCount, pTimeout);
+            if (!warmUp.valid)
+            {
+                return warmUp;
+            }
+        }
+        return run_dag(jobSystem, pGraph, pThreadCount, pTimeout);
+    }
+
+    inline void print_report_header()
+    {
+        std::cout << std::left
+                  << std::setw(10) << "shape"
+                  << std::setw(12) << "costs"
+                  << std::setw(15) << "mode"
+                  << std::setw(8) << "P"
+                  << std::setw(8) << "jobs"
+                  << std::setw(8) << "edges"
+                  << std::setw(12) << "makespan"
+                  << std::setw(12) << "crit.path"
+                  << std::setw(12) << "work/P"
+                  << std::setw(8) << "eff."
+                  << "valid\n";
+    }
+
+    inline void print_report(const dag_params &pParams, cacau::jobs::scheduling_mode pMode,
+                             size_t pThreadCount, const dag_report &pReport)
+    {
+        std::cout << std::left << std::fixed << std::setprecision(2)
+                  << std::setw(10) << shape_name(pParams.shape)
+                  << std::setw(12) << cost_name(pParams.costs)
+                  << std::setw(15) << (pMode == cacau::jobs::scheduling_mode::fifo ? "fifo" : "critical_path")
+                  << std::setw(8) << pThreadCount
+                  << std::setw(8) << pReport.jobs
+                  << std::setw(8) << pReport.edges
+                  << std::setw(12) << pReport.makespan_ms
+                  << std::setw(12) << pReport.critical_path_ms
+                  << std::setw(12) << pReport.total_work_ms / static_cast<double>(std::max<size_t>(pThreadCount, 1))
+                  << std::setw(8) << pReport.efficiency
+                  << (pReport.valid ? "yes" : (pReport.completed ? "NO" : "TIMEOUT")) << "\n";
+    }
+
+} // namespace dag_workload
@@ -0,0 +1,205 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "cacau_jobs.h"
+#include "test_util.h"
+
+using test_util::check;
+
+namespace
+{
+    bool is_line_aligned(const void* pAddress)
+    {
+        return reinterpret_cast<uintptr_t>(pAddress) % cacau::jobs::kCacheLineSize == 0;
+    }
+}
+
+/**
+ * @brief Chunks cover every element once, start on cache lines and are whole granules
+ */
+void test_partition(size_t pCount, size_t pOffset, size_t pChunks)
+{
+    std::vector<float> positions(pCount + 64);
+    std::vector<double> weights(pCount + 64);
+    float* data = positions.data() + pOffset;
+
+    cacau::jobs::batch_partition partition(pCount, {cacau::jobs::make_batch_span(data),
+                                                    cacau::jobs::make_batch_span(weights.data())}, pChunks);
+
+    check(partition.grain() == 16, "grain is a cache line of floats and of doubles");
+    check(partition.head().mBegin == 0, "head starts at zero");
+
+    std::vector<int> covered(pCount, 0);
+    auto cover = [&covered](const cacau::jobs::batch_range &pRange)
+    {
+        for (size_t i = pRange.mBegin; i < pRange.mEnd; ++i)
+        {
+            ++covered[i];
+        }
+    };
+
+    cover(partition.head());
+    for (size_t i = 0; i < partition.chunk_count(); ++i)
+    {
+        cacau::jobs::batch_range chunk = partition.chunk(i);
+        cover(chunk);
+        check(chunk.size() % partition.grain() == 0, "chunk body is whole granules");
+        if (!chunk.empty())
+        {
+            check(is_line_aligned(data + chunk.mBegin), "chunk starts on a cache line");
+        }
+    }
+    cover(partition.tail());
+    check(partition.tail().size() < partition.grain() || partition.chunk_count() == 1, "tail is shorter than a granule");
+
+    bool exactlyOnce = true;
+    for (int count : covered)
+    {
+        exactlyOnce = exactlyOnce && count == 1;
+    }
+    check(exactlyOnce, "every element is covered exactly once");
+    check(partition.chunk_count() <= std::max<size_t>(pChunks, 1), "no more chunks than requested");
+}
+
+/**
+ * @brief aligned() holds only when every span's chunk bodies start on a cache line
+ */
+void test_span_alignment()
+{
+    alignas(64) static float floats[256];
+    alignas(64) static float otherFloats[256];
+    alignas(64) static double doubles[256];
+    using cacau::jobs::make_batch_span;
+
+    cacau::jobs::batch_partition lined(256, {make_batch_span(floats), make_batch_span(doubles)}, 2, 16);
+    check(lined.aligned(), "spans starting on cache lines are aligned");
+
+    // Same offset in elements of the same size: the head aligns both
+    cacau::jobs::batch_partition shifted(250, {make_batch_span(floats + 4), make_batch_span(otherFloats + 4)}, 2, 16);
+    check(shifted.aligned(), "spans of one element size sharing an offset are aligned");
+    check(shifted.head().size() == 12, "head runs up to the first cache line");
+
+    // Same byte offset, different element sizes: 12 doubles past the offset is not a cache line
+    cacau::jobs::batch_partition mixed(250, {make_batch_span(floats + 4), make_batch_span(doubles + 2)}, 2, 16);
+    check(!mixed.aligned(), "a span whose chunks do not start on cache lines is reported");
+}
+
+/**
+ * @brief wait() runs the chunks itself when no worker gets to them
+ */
+void test_wait_helps()
+{
+    // Paused: nothing runs unless wait() does, and it leaves the job system paused
+    {
+        cacau::jobs::job_system jobSystem(2);
+        std::atomic<size_t> processed(0);
+        auto kernel = [&processed](size_t pBegin, size_t pEnd) { processed += pEnd - pBegin; };
+        cacau::jobs::batch_job<decltype(kernel)> batch(jobSystem, 10000, kernel, {}, 256);
+        batch.run();
+        check(processed == 10000, "wait runs the chunks of a paused job system");
+        check(jobSystem.get_pending_jobs() == batch.partition().chunk_count(),
+              "wait leaves the job system paused, the chunk jobs stay queued");
+        jobSystem.wait_for_all_jobs();
+        check(processed == 10000, "chunk jobs started after wait do not run their chunk again");
+    }
+
+    // Waiting inside the only worker's job
+    {
+        cacau::jobs::job_system jobSystem(1);
+        jobSystem.resume();
+        std::atomic<size_t> processed(0);
+        auto kernel = [&processed](size_t pBegin, size_t pEnd) { processed += pEnd - pBegin; };
+        jobSystem.submit(new cacau::jobs::job([&jobSystem, &kernel]
+        {
+            cacau::jobs::batch_job<decltype(kernel)> batch(jobSystem, 10000, kernel, {}, 256);
+            batch.run();
+        }, "Outer"));
+        jobSystem.wait_for_all_jobs();
+        check(processed == 10000, "wait inside a job on a single worker completes");
+    }
+}
+
+/**
+ * @brief Structure-of-arrays kernel run for several frames, compared against a serial loop
+ */
+void test_soa_kernel(size_t pThreads, size_t pCount, size_t pFrames)
+{
+    cacau::jobs::job_system jobSystem(pThreads);
+    jobSystem.resume();
+
+    std::vector<float> x(pCount), y(pCount), z(pCount), lengths(pCount), expected(pCount);
+    for (size_t i = 0; i < pCount; ++i)
+    {
+        x[i] = static_cast<float>(i % 7);
+        y[i] = static_cast<float>(i % 11);
+        z[i] = static_cast<float>(i % 13);
+    }
+
+    const float* px = x.data();
+    const float* py = y.data();
+    const float* pz = z.data();
+    float* out = lengths.data();
+    auto kernel = [px, py, pz, out](size_t pBegin, size_t pEnd)
+    {
+        for (size_t i = pBegin; i < pEnd; ++i)
+        {
+            out[i] = std::sqrt(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i]);
+        }
+    };
+
+    cacau::jobs::batch_job<decltype(kernel)> batch(jobSystem, pCount, kernel,
+        {cacau::jobs::make_batch_span(out), cacau::jobs::make_batch_span(px),
+         cacau::jobs::make_batch_span(py), cacau::jobs::make_batch_span(pz)}, 4096, "LengthKernel");
+
+    auto serialStart = std::chrono::high_resolution_clock::now();
+    for (size_t frame = 0; frame < pFrames; ++frame)
+    {
+        kernel(0, pCount);
+    }
+    auto serialEnd = std::chrono::high_resolution_clock::now();
+    expected = lengths;
+    std::fill(lengths.begin(), lengths.end(), 0.0f);
+
+    auto batchStart = std::chrono::high_resolution_clock::now();
+    for (size_t frame = 0; frame < pFrames; ++frame)
+    {
+        batch.run();
+    }
+    auto batchEnd = std::chrono::high_resolution_clock::now();
+
+    check(lengths == expected, "batch kernel matches the serial loop");
+
+    std::cout << "Threads: " << pThreads << ", "
+              << "Elements: " << pCount << ", "
+              << "Chunks: " << batch.partition().chunk_count() << ", "
+              << "Serial: " << std::chrono::duration<double, std::milli>(serialEnd - serialStart).count() / pFrames
+              << " ms/frame, "
+              << "Batch: " << std::chrono::duration<double, std::milli>(batchEnd - batchStart).count() / pFrames
+              << " ms/frame\n";
+}
+
+int main()
+{
+    std::cout << "Batch Job Test Started.\n";
+
+    const size_t counts[] = {0, 1, 15, 17, 1000, 65536 + 7};
+    for (size_t count : counts)
+    {
+        for (size_t offset = 0; offset < 16; offset += 5)
+        {
+            test_partition(count, offset, 4);
+        }
+    }
+
+    test_span_alignment();
+    test_wait_helps();
+
+    test_soa_kernel(1, 1 << 20, 10);
+    test_soa_kernel(4, 1 << 20, 10);
+    test_soa_kernel(4, 1000, 10);
+
+    return test_util::report("Batch Job");
+}
@@ -0,0 +1,157 @@
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "dag_workload.h"
+
+/**
+ * @brief Jobs submitted with dependencies can be deleted as soon as wait() returns
+ * @details Each job of the chain is registered as a dependant of the previous one while
+ *          that one may be finishing, then the previous one is waited for and deleted
+ */
+void test_wait_then_delete(cacau::jobs::scheduling_mode pMode)
+{
+    cacau::jobs::job_system jobSystem(4);
+    jobSystem.set_scheduling_mode(pMode);
+
+    std::atomic<int> ran(0);
+    auto *seed = new cacau::jobs::job([] {}, "Seed");
+    auto *previous = new cacau::jobs::job([&ran] { ++ran; }, "Link");
+    jobSystem.submit_with_dependencies(previous, {seed});
+    jobSystem.submit(seed);
+    jobSystem.resume();
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        auto *next = new cacau::jobs::job([&ran] { ++ran; }, "Link");
+        jobSystem.submit_with_dependencies(next, {previous});
+        jobSystem.wait(previous);
+        delete previous;
+        previous = next;
+    }
+    jobSystem.wait(previous);
+    delete previous;
+
+    jobSystem.wait_for_all_jobs();
+    test_util::check(ran == 2001, "waited dependants run once and can be deleted");
+}
+
+/**
+ * @brief Critical-path ranks reach dependencies submitted before their dependants
+ * @details One worker runs a chain and independent fillers, all submitted before any runs.
+ *          The chain's head is submitted after the fillers and before its dependants, so it is
+ *          only ranked above them once the rest of the chain raised its rank
+ */
+void test_dependency_first_ranking()
+{
+    cacau::jobs::job_system jobSystem(1);
+    jobSystem.set_scheduling_mode(cacau::jobs::scheduling_mode::critical_path);
+
+    std::mutex orderMutex;
+    std::string order;
+    auto logged = [&orderMutex, &order](char pLabel)
+    {
+        return [&orderMutex, &order, pLabel]
+        {
+            std::lock_guard<std::mutex> lock(orderMutex);
+            order += pLabel;
+        };
+    };
+
+    for (int i = 0; i < 8; ++i)
+    {
+        jobSystem.submit(new cacau::jobs::job(logged('F'), "Filler"));
+    }
+
+    const int kChainLength = 6;
+    std::vector<cacau::jobs::job *> chain;
+    chain.push_back(new cacau::jobs::job(logged('C'), "Chain"));
+    jobSystem.submit(chain.back());
+    for (int i = 1; i < kChainLength; ++i)
+    {
+        chain.push_back(new cacau::jobs::job(logged('C'), "Chain"));
+        jobSystem.submit_with_dependencies(chain.back(), {chain[i - 1]});
+    }
+    jobSystem.wait_for_all_jobs();
+
+    test_util::check(order.size() == 8 + kChainLength, "every job runs");
+    // The chain's last job has no more work after it than a filler, it may run after them
+    test_util::check(order.compare(0, kChainLength - 1, std::string(kChainLength - 1, 'C')) == 0,
+                     "chain submitted dependencies first runs ahead of shorter jobs");
+
+    for (size_t i = 1; i < chain.size(); ++i)
+    {
+        delete chain[i];
+    }
+}
+
+/**
+ * @brief Runs every graph shape and cost distribution and reports scheduler efficiency
+ * @return 0 if every job of every graph ran exactly once after all its dependencies
+ */
+int main()
+{
+    using namespace dag_workload;
+
+    const dag_shape shapes[] = {dag_shape::layered, dag_shape::fork_join, dag_shape::random, dag_shape::chain};
+    const cost_distribution costs[] = {cost_distribution::constant, cost_distribution::uniform,
+                                       cost_distribution::exponential, cost_distribution::bimodal};
+    const size_t threadCounts[] = {2, 4};
+    const cacau::jobs::scheduling_mode modes[] = {cacau::jobs::scheduling_mode::fifo,
+                                                  cacau::jobs::scheduling_mode::critical_path};
+
+    std::cout << "DAG Workload Test Started (hardware threads: "
+              << std::thread::hardware_concurrency() << ").\n";
+    test_wait_then_delete(cacau::jobs::scheduling_mode::fifo);
+    test_wait_then_delete(cacau::jobs::scheduling_mode::critical_path);
+    test_dependency_first_ranking();
+
+    print_report_header();
+
+    uint32_t seed = 1;
+    for (dag_shape shape : shapes)
+    {
+        for (cost_distribution cost : costs)
+        {
+            dag_params params;
+            params.shape = shape;
+            params.costs = cost;
+            params.seed = seed++;
+            switch (shape)
+            {
+            case dag_shape::layered:
+                params.width = 32;
+                params.depth = 16;
+                params.edge_density = 0.1;
+                break;
+            case dag_shape::fork_join:
+                params.width = 32;
+                params.depth = 16;
+                break;
+            case dag_shape::random:
+                params.width = 32;
+                params.depth = 16;
+                params.edge_density = 0.01;
+                break;
+            case dag_shape::chain:
+                params.width = 4;
+                params.depth = 128;
+                break;
+            }
+
+            dag_graph graph = generate_dag(params);
+            for (size_t threads : threadCounts)
+            {
+                for (cacau::jobs::scheduling_mode mode : modes)
+                {
+                    dag_report report = run_dag(graph, threads, mode);
+                    print_report(params, mode, threads, report);
+                    test_util::check(report.valid, "every job runs once, after all its dependencies");
+                }
+            }
+        }
+    }
+
+    return test_util::report("DAG Workload");
+}
@@ -0,0 +1,123 @@
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "cacau_jobs.h"
+#include "test_util.h"
+
+using test_util::check;
+
+namespace
+{
+    using test_clock = std::chrono::high_resolution_clock;
+
+    struct execution_log
+    {
+        std::mutex mMutex;
+        std::vector<std::string> mOrder;
+
+        cacau::jobs::job* make_job(const char* pName)
+        {
+            return new cacau::jobs::job([this, pName]
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mOrder.push_back(pName);
+            }, pName);
+        }
+    };
+}
+
+/**
+ * @brief Jobs queued on one worker run earliest deadline first, then jobs without deadline
+ */
+void test_edf_order()
+{
+    cacau::jobs::job_system jobSystem(1);
+    jobSystem.set_scheduling_mode(cacau::jobs::scheduling_mode::earliest_deadline);
+    execution_log log;
+
+    auto frameEnd = test_clock::now() + std::chrono::seconds(10);
+    auto *noDeadline = log.make_job("none");
+    auto *late = log.make_job("late");
+    auto *early = log.make_job("early");
+    auto *middle = log.make_job("middle");
+    late->set_deadline(frameEnd + std::chrono::milliseconds(3));
+    early->set_deadline(frameEnd + std::chrono::milliseconds(1));
+    middle->set_deadline(frameEnd + std::chrono::milliseconds(2));
+
+    // The job system starts paused, so everything is queued before the worker picks anything
+    jobSystem.submit(noDeadline);
+    jobSystem.submit(late);
+    jobSystem.submit(early);
+    jobSystem.submit(middle);
+    jobSystem.wait_for_all_jobs();
+
+    std::vector<std::string> expected = {"early", "middle", "late", "none"};
+    check(log.mOrder == expected, "jobs run earliest deadline first");
+
+    auto stats = jobSystem.get_deadline_stats();
+    check(stats.met == 3 && stats.missed == 0, "deadlines met are counted");
+
+    jobSystem.reset_deadline_stats();
+    check(jobSystem.get_deadline_stats().met == 0, "deadline stats reset");
+}
+
+/**
+ * @brief Expired jobs are dropped, but their dependants still run
+ */
+void test_drop_policy()
+{
+    cacau::jobs::job_system jobSystem(2);
+    jobSystem.set_scheduling_mode(cacau::jobs::scheduling_mode::earliest_deadline);
+    jobSystem.set_deadline_miss_policy(cacau::jobs::deadline_miss_policy::drop);
+    execution_log log;
+
+    auto *expired = log.make_job("expired");
+    auto *dependant = log.make_job("dependant");
+    expired->set_deadline(test_clock::now() - std::chrono::milliseconds(1));
+
+    jobSystem.submit_with_dependencies(dependant, {expired});
+    jobSystem.submit(expired);
+    jobSystem.wait(dependant);
+    jobSystem.wait_for_all_jobs();
+
+    std::vector<std::string> expected = {"dependant"};
+    check(log.mOrder == expected, "dropped job does not run, its dependant does");
+    check(jobSystem.get_deadline_stats().dropped == 1, "dropped jobs are counted");
+
+    delete dependant;
+}
+
+/**
+ * @brief Expired jobs are deferred behind the jobs without deadline
+ */
+void test_defer_policy()
+{
+    cacau::jobs::job_system jobSystem(1);
+    jobSystem.set_scheduling_mode(cacau::jobs::scheduling_mode::earliest_deadline);
+    jobSystem.set_deadline_miss_policy(cacau::jobs::deadline_miss_policy::defer);
+    execution_log log;
+
+    auto *expired = log.make_job("expired");
+    expired->set_deadline(test_clock::now() - std::chrono::milliseconds(1));
+
+    jobSystem.submit(expired);
+    jobSystem.submit(log.make_job("first"));
+    jobSystem.submit(log.make_job("second"));
+    jobSystem.wait_for_all_jobs();
+
+    std::vector<std::string> expected = {"first", "second", "expired"};
+    check(log.mOrder == expected, "deferred job runs after jobs without deadline");
+
+    auto stats = jobSystem.get_deadline_stats();
+    check(stats.deferred == 1 && stats.missed == 1 && stats.met == 0, "deferred job counts as missed");
+}
+
+int main()
+{
+    std::cout << "Deadline Test Started.\n";
+    test_edf_order();
+    test_drop_policy();
+    test_defer_policy();
+    return test_util::report("Deadline");
+}
@@ -0,0 +1,98 @@
+#include <iostream>
+#include <thread>
+#include "cacau_jobs.h"
+#include "test_util.h"
+
+using test_util::check;
+
+/**
+ * @brief Checks bucketing accuracy of the histogram on known values
+ */
+void test_histogram()
+{
+    cacau::jobs::latency_histogram histogram;
+    check(histogram.percentile(50.0) == 0, "empty histogram percentile is 0");
+
+    // 1..100000 ns, uniformly
+    for (uint64_t i = 1; i <= 100000; ++i)
+    {
+        histogram.record(i);
+    }
+    check(histogram.count() == 100000, "histogram counts every sample");
+    check(histogram.min() == 1 && histogram.max() == 100000, "histogram tracks min and max");
+
+    const double percentiles[] = {50.0, 99.0, 99.9};
+    for (double percentile : percentiles)
+    {
+        double expected = percentile / 100.0 * 100000.0;
+        double actual = static_cast<double>(histogram.percentile(percentile));
+        check(actual >= expected && actual <= expected * 1.07, "percentile within bucket precision");
+    }
+
+    cacau::jobs::latency_histogram other;
+    other.record(uint64_t(1) << 50); // Clamped into the last bucket
+    histogram.merge(other);
+    check(histogram.count() == 100001, "merge adds counts");
+    check(histogram.percentile(100.0) == (uint64_t(1) << 50), "largest percentile is the max sample");
+
+    histogram.reset();
+    check(histogram.count() == 0 && histogram.max() == 0, "reset clears samples");
+}
+
+/**
+ * @brief Runs a fast and a slow job type and checks they are recorded separately
+ */
+void test_job_latency()
+{
+    constexpr uint32_t kSlowType = 7;
+    constexpr size_t kJobCount = 20;
+
+    cacau::jobs::job_system jobSystem(4);
+    jobSystem.set_latency_tracking(true);
+
+    for (size_t i = 0; i < kJobCount; ++i)
+    {
+        jobSystem.submit(new cacau::jobs::job([] {}, "FastJob"));
+
+        auto *slowJob = new cacau::jobs::job([]
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }, "SlowJob");
+        slowJob->set_type_id(kSlowType);
+        jobSystem.submit(slowJob);
+    }
+
+    auto *root = new cacau::jobs::job([] {}, "RootJob");
+    auto *dependent = new cacau::jobs::job([] {}, "DependentJob");
+    jobSystem.submit_with_dependencies(dependent, {root});
+    jobSystem.submit(root);
+
+    jobSystem.wait_for_all_jobs();
+    jobSystem.print_latency_stats();
+
+    auto fast = jobSystem.get_latency_stats("FastJob");
+    auto slow = jobSystem.get_type_latency_stats(kSlowType);
+    auto dependentStats = jobSystem.get_latency_stats("DependentJob");
+
+    check(fast.run_time.count() == kJobCount, "fast jobs recorded by name");
+    check(fast.queue_wait.count() == kJobCount, "fast jobs queue wait recorded");
+    check(slow.run_time.count() == kJobCount, "slow jobs recorded by type id");
+    check(jobSystem.get_latency_stats("SlowJob").run_time.count() == 0, "typed jobs are not recorded by name");
+    check(slow.run_time.percentile(50.0) >= 2000000, "slow job p50 covers its sleep");
+    check(fast.run_time.percentile(50.0) < slow.run_time.percentile(50.0), "fast jobs are faster");
+    check(dependentStats.ready_wait.count() == 1, "dependent job ready wait recorded");
+    check(jobSystem.get_latency_stats("RootJob").ready_wait.count() == 0, "root job has no ready wait");
+
+    jobSystem.reset_latency_stats();
+    check(jobSystem.get_latency_stats("FastJob").run_time.count() == 0, "reset clears job stats");
+
+    delete dependent;
+}
+
+int main()
+{
+    std::cout << "Latency Test Started.\n";
+    test_histogram();
+    test_job_latency();
+    return test_util::report("Latency");
+}
@@ -0,0 +1,227 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cacau_jobs.h"
+#include "test_util.h"
+
+using test_util::check;
+using test_util::time_ms;
+
+namespace
+{
+    std::vector<uint32_t> random_values(size_t pCount, uint32_t pSeed, uint32_t pRange = 0xffffffffu)
+    {
+        std::mt19937 generator(pSeed);
+        std::uniform_int_distribution<uint32_t> distribution(0, pRange);
+        std::vector<uint32_t> values(pCount);
+        for (auto &value : values)
+        {
+            value = distribution(generator);
+        }
+        return values;
+    }
+
+    bool is_even(uint32_t pValue)
+    {
+        return pValue % 2 == 0;
+    }
+}
+
+/**
+ * @brief Results match the std:: algorithms, for sizes around the grain and with duplicates
+ */
+void test_correctness(size_t pThreads)
+{
+    cacau::jobs::job_system jobSystem(pThreads);
+    jobSystem.resume();
+    const size_t sizes[] = {0, 1, 2, 1000, 16 * 1024, 16 * 1024 + 1, 100000, 1000003};
+
+    for (size_t size : sizes)
+    {
+        // Sort, with few distinct values to exercise ties in the merge splits
+        std::vector<uint32_t> values = random_values(size, static_cast<uint32_t>(size), 1000);
+        std::vector<uint32_t> expected = values;
+        std::sort(expected.begin(), expected.end());
+        cacau::jobs::parallel_sort(jobSystem, values.begin(), values.end());
+        check(values == expected, "parallel_sort matches std::sort");
+
+        values = random_values(size, static_cast<uint32_t>(size) + 1);
+        expected = values;
+        std::sort(expected.begin(), expected.end(), std::greater<uint32_t>());
+        cacau::jobs::parallel_sort(jobSystem, values.data(), values.data() + size, std::greater<uint32_t>());
+        check(values == expected, "parallel_sort honors the comparator");
+
+        // Transform
+        std::vector<uint64_t> squares(size);
+        cacau::jobs::parallel_transform(jobSystem, values.begin(), values.end(), squares.begin(),
+                                        [](uint32_t pValue) { return uint64_t(pValue) * pValue; });
+        bool transformed = true;
+        for (size_t i = 0; i < size; ++i)
+        {
+            transformed = transformed && squares[i] == uint64_t(values[i]) * values[i];
+        }
+        check(transformed, "parallel_transform applies the operation to every element");
+
+        // Partition
+        values = random_values(size, static_cast<uint32_t>(size) + 2);
+        std::vector<uint32_t> sortedInput = values;
+        std::sort(sortedInput.begin(), sortedInput.end());
+        auto split = cacau::jobs::parallel_partition(jobSystem, values.begin(), values.end(), is_even);
+        check(std::all_of(values.begin(), split, is_even) && std::none_of(split, values.end(), is_even),
+              "parallel_partition puts passing elements first");
+        std::sort(values.begin(), values.end());
+        check(values == sortedInput, "parallel_partition keeps every element");
+
+        // Find, first match wins even when later chunks match earlier
+        values.assign(size, 0);
+        check(cacau::jobs::parallel_find_if(jobSystem, values.begin(), values.end(),
+                                            [](uint32_t pValue) { return pValue != 0; }) == values.end(),
+              "parallel_find_if returns last without a match");
+        if (size > 0)
+        {
+            for (size_t i = size / 3; i < size; i += 7)
+            {
+                values[i] = 1;
+            }
+            auto found = cacau::jobs::parallel_find_if(jobSystem, values.begin(), values.end(),
+                                                       [](uint32_t pValue) { return pValue != 0; }, 1024);
+            check(found - values.begin() == static_cast<ptrdiff_t>(size / 3), "parallel_find_if returns the first match");
+        }
+    }
+}
+
+/**
+ * @brief A paused job system is left paused, the caller sorts on its own
+ */
+void test_paused()
+{
+    cacau::jobs::job_system jobSystem(2);
+    std::vector<uint32_t> values = random_values(100000, 3);
+    std::vector<uint32_t> expected = values;
+    std::sort(expected.begin(), expected.end());
+
+    cacau::jobs::parallel_sort(jobSystem, values.begin(), values.end());
+    check(values == expected, "parallel_sort on a paused job system");
+
+    std::atomic<bool> ran(false);
+    jobSystem.submit(new cacau::jobs::job([&ran] { ran = true; }, "AfterSort"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    check(!ran, "parallel algorithms do not resume a paused job system");
+    jobSystem.wait_for_all_jobs();
+}
+
+/**
+ * @brief Elements that own memory are moved through the sort buffer and destroyed once
+ */
+void test_sort_strings()
+{
+    cacau::jobs::job_system jobSystem(2);
+    jobSystem.resume();
+    std::vector<std::string> values;
+    for (uint32_t value : random_values(50000, 11))
+    {
+        values.push_back("value-" + std::to_string(value) + std::string(32, 'x'));
+    }
+    std::vector<std::string> expected = values;
+    std::sort(expected.begin(), expected.end());
+
+    cacau::jobs::parallel_sort(jobSystem, values.begin(), values.end(), std::less<std::string>(), 1024);
+    check(values == expected, "parallel_sort of strings matches std::sort");
+}
+
+/**
+ * @brief Algorithms called from inside a job finish even when every worker is busy
+ */
+void test_nested()
+{
+    cacau::jobs::job_system jobSystem(1);
+    std::vector<uint32_t> values = random_values(200000, 7);
+    std::vector<uint32_t> expected = values;
+    std::sort(expected.begin(), expected.end());
+
+    jobSystem.submit(new cacau::jobs::job([&jobSystem, &values]
+    {
+        cacau::jobs::parallel_sort(jobSystem, values.begin(), values.end());
+    }, "NestedSort"));
+    jobSystem.wait_for_all_jobs();
+
+    check(values == expected, "parallel_sort inside a job");
+}
+
+/**
+ * @brief Parallel algorithms against std:: baselines, sizes growing tenfold from 1K
+ */
+void benchmark(size_t pThreads, size_t pMaxElements)
+{
+    cacau::jobs::job_system jobSystem(pThreads);
+    jobSystem.resume();
+
+    std::cout << "Threads: " << pThreads << "\n";
+    std::cout << std::setw(12) << "Elements"
+              << std::setw(12) << "std::sort" << std::setw(12) << "par_sort"
+              << std::setw(12) << "transform" << std::setw(12) << "par_trans"
+              << std::setw(12) << "partition" << std::setw(12) << "par_part"
+              << std::setw(12) << "find_if" << std::setw(12) << "par_find" << "  (ms)\n";
+
+    for (size_t size = 1000; size <= pMaxElements; size *= 10)
+    {
+        std::vector<uint32_t> input = random_values(size, 42);
+        input[size * 3 / 4] = static_cast<uint32_t>(size);
+        std::vector<uint32_t> values = input;
+        std::vector<uint32_t> output(size);
+        auto scale = [](uint32_t pValue) { return pValue * 3u + 1u; };
+        auto target = [size](uint32_t pValue) { return pValue == size; };
+
+        double stdSort = time_ms([&values] { std::sort(values.begin(), values.end()); });
+        values = input;
+        double parSort = time_ms([&jobSystem, &values] { cacau::jobs::parallel_sort(jobSystem, values.begin(), values.end()); });
+
+        double serialTransform = time_ms([&] { std::transform(input.begin(), input.end(), output.begin(), scale); });
+        double parTransform = time_ms([&] { cacau::jobs::parallel_transform(jobSystem, input.begin(), input.end(), output.begin(), scale); });
+
+        values = input;
+        double serialPartition = time_ms([&values] { std::partition(values.begin(), values.end(), is_even); });
+        values = input;
+        double parPartition = time_ms([&] { cacau::jobs::parallel_partition(jobSystem, values.begin(), values.end(), is_even); });
+
+        size_t serialIndex = 0;
+        size_t parIndex = 0;
+        double serialFind = time_ms([&] { serialIndex = std::find_if(input.begin(), input.end(), target) - input.begin(); });
+        double parFind = time_ms([&] { parIndex = cacau::jobs::parallel_find_if(jobSystem, input.begin(), input.end(), target) - input.begin(); });
+        check(serialIndex == parIndex, "benchmark find results agree");
+
+        std::cout << std::fixed << std::setprecision(3) << std::setw(12) << size
+                  << std::setw(12) << stdSort << std::setw(12) << parSort
+                  << std::setw(12) << serialTransform << std::setw(12) << parTransform
+                  << std::setw(12) << serialPartition << std::setw(12) << parPartition
+                  << std::setw(12) << serialFind << std::setw(12) << parFind << "\n";
+    }
+    std::cout.unsetf(std::ios::fixed);
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "Parallel Algorithms Test Started.\n";
+
+    // Pass a larger size, e.g. 100000000, for the full benchmark range
+    size_t maxElements = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    test_correctness(1);
+    test_correctness(4);
+    test_paused();
+    test_sort_strings();
+    test_nested();
+
+    benchmark(1, maxElements);
+    benchmark(std::max(2u, std::thread::hardware_concurrency()), maxElements);
+
+    return test_util::report("Parallel Algorithms");
+}
@@ -0,0 +1,317 @@
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "cacau_jobs.h"
+#include "test_util.h"
+
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+using test_util::check;
+
+namespace
+{
+    /**
+     * @brief Peak resident set size of the process in MB, 0 where unsupported
+     */
+    double peak_rss_mb()
+    {
+#ifdef __linux__
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss / 1024.0;
+#else
+        return 0.0;
+#endif
+    }
+
+    uint64_t mix(uint64_t pValue)
+    {
+        pValue ^= pValue >> 33;
+        pValue *= 0xff51afd7ed558ccdull;
+        pValue ^= pValue >> 33;
+        return pValue;
+    }
+
+    uint64_t fnv1a(const char* pData, size_t pSize)
+    {
+        uint64_t hash = 1469598103934665603ull;
+        for (size_t i = 0; i < pSize; ++i)
+        {
+            hash = (hash ^ static_cast<unsigned char>(pData[i])) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    struct counted_item
+    {
+        uint64_t mValue = 0;
+        uint64_t mResult = 0;
+    };
+}
+
+/**
+ * @brief Order, exclusivity and token limit for every stage mode
+ */
+void test_stage_modes(size_t pThreads, size_t pTokenLimit, uint64_t pItems)
+{
+    cacau::jobs::job_system jobSystem(pThreads);
+    cacau::jobs::parallel_pipeline<counted_item> pipeline(jobSystem, pTokenLimit, "CountedPipeline");
+
+    uint64_t produced = 0;
+    std::atomic<int> inFlight(0);
+    std::atomic<int> maxInFlight(0);
+    std::atomic<int> inSerialStage(0);
+    std::atomic<int> serialOverlaps(0);
+    uint64_t anyOrderSum = 0;
+    std::vector<uint64_t> ordered;
+
+    pipeline.set_source([&](counted_item &pItem)
+    {
+        if (produced == pItems)
+        {
+            return false;
+        }
+        pItem.mValue = produced++;
+        int current = ++inFlight;
+        int previous = maxInFlight.load();
+        while (current > previous && !maxInFlight.compare_exchange_weak(previous, current))
+        {
+        }
+        return true;
+    })
+    .add_stage(cacau::jobs::pipeline_stage_mode::parallel, [](counted_item &pItem)
+    {
+        pItem.mResult = pItem.mValue;
+        for (int i = 0; i < 50; ++i)
+        {
+            pItem.mResult = mix(pItem.mResult + 1);
+        }
+    })
+    .add_stage(cacau::jobs::pipeline_stage_mode::serial_any_order, [&](counted_item &pItem)
+    {
+        if (++inSerialStage != 1)
+        {
+            ++serialOverlaps;
+        }
+        anyOrderSum += pItem.mValue;
+        --inSerialStage;
+    })
+    .add_stage(cacau::jobs::pipeline_stage_mode::parallel, [](counted_item &pItem)
+    {
+        pItem.mResult ^= pItem.mValue;
+    })
+    .add_stage(cacau::jobs::pipeline_stage_mode::serial_in_order, [&](counted_item &pItem)
+    {
+        ordered.push_back(pItem.mValue);
+        --inFlight;
+    });
+
+    pipeline.run();
+
+    bool inOrder = ordered.size() == pItems;
+    for (uint64_t i = 0; inOrder && i < pItems; ++i)
+    {
+        inOrder = ordered[i] == i;
+    }
+    check(pipeline.processed_items() == pItems, "every item leaves the last stage");
+    check(inOrder, "serial_in_order stage sees items in source order");
+    check(anyOrderSum == pItems * (pItems - 1) / 2 || pItems == 0, "serial_any_order stage sees every item");
+    check(serialOverlaps == 0, "serial_any_order stage never runs concurrently");
+    check(maxInFlight <= static_cast<int>(pTokenLimit), "items in flight never exceed the token limit");
+
+    // A pipeline can be run again
+    produced = 0;
+    ordered.clear();
+    pipeline.run();
+    check(ordered.size() == pItems, "pipeline runs again");
+}
+
+/**
+ * @brief Chunk of a log file flowing through read, decode, transform and write
+ */
+struct log_chunk
+{
+    std::vector<char> mData;
+    size_t mSize = 0;
+    uint64_t mLines = 0;
+    uint64_t mChecksum = 0;
+};
+
+/**
+ * @brief Writes pMegabytes of log lines to pFile and rewinds it
+ * @return false if the file could not be written
+ */
+bool generate_input(std::FILE* pFile, size_t pMegabytes)
+{
+    char line[128];
+    size_t written = 0;
+    for (uint64_t i = 0; written < pMegabytes * 1024 * 1024; ++i)
+    {
+        int length = std::snprintf(line, sizeof(line), "%llu level=%s request=/api/item/%llu latency_us=%llu\n",
+                                   static_cast<unsigned long long>(i), i % 17 == 0 ? "warn" : "info",
+                                   static_cast<unsigned long long>(mix(i) % 100000),
+                                   static_cast<unsigned long long>(mix(i + 7) % 5000));
+        if (std::fwrite(line, 1, length, pFile) != static_cast<size_t>(length))
+        {
+            return false;
+        }
+        written += length;
+    }
+    std::rewind(pFile);
+    return true;
+}
+
+/**
+ * @brief Streams a generated log file through the pipeline, then loads it whole for comparison
+ */
+void benchmark_log_ingestion(size_t pThreads, size_t pMegabytes, size_t pTokenLimit, size_t pChunkBytes)
+{
+    // Anonymous temporary files, nothing is left in the working directory
+    std::FILE* input = std::tmpfile();
+    std::FILE* output = std::tmpfile();
+    bool ready = input != nullptr && output != nullptr && generate_input(input, pMegabytes);
+    check(ready, "temporary log files are created and written");
+    if (!ready)
+    {
+        if (input != nullptr)
+        {
+            std::fclose(input);
+        }
+        if (output != nullptr)
+        {
+            std::fclose(output);
+        }
+        return;
+    }
+
+    // Uppercases the log level and sums line checksums, the same work in both runs
+    auto decode = [](log_chunk &pChunk)
+    {
+        pChunk.mLines = std::count(pChunk.mData.begin(), pChunk.mData.begin() + pChunk.mSize, '\n');
+        pChunk.mChecksum = fnv1a(pChunk.mData.data(), pChunk.mSize);
+    };
+    auto transform = [](log_chunk &pChunk)
+    {
+        for (size_t i = 0; i < pChunk.mSize; ++i)
+        {
+            char c = pChunk.mData[i];
+            pChunk.mData[i] = c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+        }
+    };
+
+    double rssBefore = peak_rss_mb();
+    uint64_t streamLines = 0;
+    uint64_t streamChecksum = 0;
+    double streamSeconds = 0.0;
+    {
+        cacau::jobs::job_system jobSystem(pThreads);
+        cacau::jobs::parallel_pipeline<log_chunk> pipeline(jobSystem, pTokenLimit, "LogPipeline");
+
+        pipeline.set_source([input, pChunkBytes](log_chunk &pChunk)
+        {
+            // Chunks end at a line break, the rest of the line is read with the next chunk
+            pChunk.mData.resize(pChunkBytes);
+            pChunk.mSize = std::fread(pChunk.mData.data(), 1, pChunkBytes, input);
+            size_t end = pChunk.mSize;
+            while (end > 0 && pChunk.mData[end - 1] != '\n')
+            {
+                --end;
+            }
+            if (end > 0 && end < pChunk.mSize)
+            {
+                std::fseek(input, -static_cast<long>(pChunk.mSize - end), SEEK_CUR);
+                pChunk.mSize = end;
+            }
+            return pChunk.mSize > 0;
+        })
+        .add_stage(cacau::jobs::pipeline_stage_mode::parallel, decode)
+        .add_stage(cacau::jobs::pipeline_stage_mode::parallel, transform)
+        .add_stage(cacau::jobs::pipeline_stage_mode::serial_in_order, [output, &streamLines, &streamChecksum](log_chunk &pChunk)
+        {
+            std::fwrite(pChunk.mData.data(), 1, pChunk.mSize, output);
+            streamLines += pChunk.mLines;
+            streamChecksum += pChunk.mChecksum;
+        });
+
+        auto start = std::chrono::high_resolution_clock::now();
+        pipeline.run();
+        auto end = std::chrono::high_resolution_clock::now();
+        streamSeconds = std::chrono::duration<double>(end - start).count();
+    }
+    double rssStream = peak_rss_mb();
+
+    // Whole file in memory, as when every item's job chain is created up front
+    uint64_t wholeLines = 0;
+    uint64_t wholeChecksum = 0;
+    double wholeSeconds = 0.0;
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        std::rewind(input);
+        std::vector<log_chunk> chunks;
+        while (true)
+        {
+            log_chunk chunk;
+            chunk.mData.resize(pChunkBytes);
+            chunk.mSize = std::fread(chunk.mData.data(), 1, pChunkBytes, input);
+            if (chunk.mSize == 0)
+            {
+                break;
+            }
+            chunks.push_back(std::move(chunk));
+        }
+
+        // Lines split across chunks change the per-chunk checksums, only the line count is compared
+        std::rewind(output);
+        for (auto &chunk : chunks)
+        {
+            decode(chunk);
+            transform(chunk);
+            std::fwrite(chunk.mData.data(), 1, chunk.mSize, output);
+            wholeLines += chunk.mLines;
+            wholeChecksum += chunk.mChecksum;
+        }
+        std::fflush(output);
+        auto end = std::chrono::high_resolution_clock::now();
+        wholeSeconds = std::chrono::duration<double>(end - start).count();
+    }
+    double rssWhole = peak_rss_mb();
+
+    check(streamLines == wholeLines && streamLines > 0, "pipeline sees every line of the input");
+
+    std::cout << "Threads: " << pThreads << ", "
+              << "Input: " << pMegabytes << " MB, "
+              << "Tokens: " << pTokenLimit << ", "
+              << "Chunk: " << pChunkBytes / 1024 << " KB\n"
+              << "  Pipeline: " << pMegabytes / streamSeconds << " MB/s, "
+              << "peak RSS " << rssStream << " MB (+" << rssStream - rssBefore << ")\n"
+              << "  Whole file: " << pMegabytes / wholeSeconds << " MB/s, "
+              << "peak RSS " << rssWhole << " MB (+" << rssWhole - rssStream << ")\n";
+
+    std::fclose(input);
+    std::fclose(output);
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "Pipeline Test Started.\n";
+
+    // Pass a larger size in MB, e.g. 4096, for a multi-GB input
+    size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+
+    test_stage_modes(1, 1, 1000);
+    test_stage_modes(1, 8, 1000);
+    test_stage_modes(4, 4, 5000);
+    test_stage_modes(4, 16, 5000);
+    test_stage_modes(4, 16, 0);
+
+    benchmark_log_ingestion(4, megabytes, 8, 1024 * 1024);
+
+    return test_util::report("Pipeline");
+}
@@ -0,0 +1,121 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include "cacau_jobs.h"
+#include "test_util.h"
+
+using test_util::check;
+
+/**
+ * @brief Measures the per-job overhead of the job system configuration this test was built with
+ * @details Built twice, against the full and the CACAU_JOBS_MINIMAL library, the difference
+ *          between both outputs is the cost of the compiled-in features. TestPolicyComparison
+ *          runs both builds and prints them side by side
+ */
+double measure_overhead(size_t pThreads, size_t pJobs)
+{
+    cacau::jobs::job_system jobSystem(pThreads);
+    jobSystem.pause();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < pJobs; ++i)
+    {
+        jobSystem.submit(new cacau::jobs::job([] {}, "EmptyJob"));
+    }
+    jobSystem.wait_for_all_jobs();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(pJobs);
+}
+
+/**
+ * @brief Setters of compiled-out features report that they had no effect
+ */
+void test_compiled_out_features()
+{
+    using traits = cacau::jobs::job_system_traits;
+    cacau::jobs::job_system jobSystem(1);
+
+    check(jobSystem.set_scheduling_mode(cacau::jobs::scheduling_mode::critical_path) == traits::kPriorityQueues,
+          "set_scheduling_mode reports whether priority queues are compiled in");
+    check(jobSystem.set_scheduling_mode(cacau::jobs::scheduling_mode::fifo), "fifo is always available");
+    check(jobSystem.set_deadline_miss_policy(cacau::jobs::deadline_miss_policy::drop) == traits::kPriorityQueues,
+          "set_deadline_miss_policy reports whether deadline policies are compiled in");
+    check(jobSystem.set_latency_tracking(true) == traits::kTracing,
+          "set_latency_tracking reports whether tracing is compiled in");
+    check(jobSystem.is_latency_tracking() == traits::kTracing, "latency tracking stays off when compiled out");
+
+    // Deadline counters come with the miss policies, so a build never drops jobs it does not count
+    jobSystem.set_deadline_miss_policy(cacau::jobs::deadline_miss_policy::run);
+    auto *late = new cacau::jobs::job([] {}, "Late");
+    late->set_deadline(std::chrono::high_resolution_clock::now() - std::chrono::milliseconds(1));
+    jobSystem.submit(late);
+    jobSystem.wait_for_all_jobs();
+    check(jobSystem.get_deadline_stats().missed == (traits::kPriorityQueues ? 1u : 0u),
+          "deadline misses are counted exactly when deadline policies are compiled in");
+
+    // Without timers delayed jobs are refused and stay with the caller
+    std::atomic<int> delayedRuns{0};
+    auto *delayed = new cacau::jobs::job([&delayedRuns] { ++delayedRuns; }, "Delayed");
+    bool scheduled = jobSystem.submit_after(std::chrono::milliseconds(1), delayed);
+    check(scheduled == traits::kTimers, "submit_after reports whether timers are compiled in");
+    auto *periodic = new cacau::jobs::job([] {}, "Periodic");
+    uint64_t timerId = jobSystem.submit_periodic(std::chrono::milliseconds(1), periodic);
+    check((timerId != 0) == traits::kTimers, "submit_periodic reports whether timers are compiled in");
+    if (!scheduled)
+    {
+        delete delayed;
+    }
+    if (timerId == 0)
+    {
+        delete periodic;
+    }
+    else
+    {
+        jobSystem.cancel_periodic(timerId);
+    }
+    jobSystem.wait_for_all_jobs();
+    check(delayedRuns.load() == (scheduled ? 1 : 0), "scheduled delayed jobs run once");
+
+    // Arena jobs run in every build, only their queue differs
+    std::atomic<int> arenaRuns{0};
+    {
+        cacau::jobs::task_arena arena(jobSystem, 1);
+        for (int i = 0; i < 8; ++i)
+        {
+            arena.submit(new cacau::jobs::job([&arenaRuns] { ++arenaRuns; }, "ArenaJob"));
+        }
+        arena.wait_for_all_jobs();
+        check(arenaRuns.load() == 8, "arena jobs run whether task arenas are compiled in or not");
+    }
+}
+
+int main()
+{
+    constexpr size_t kJobs = 200000;
+    const size_t threadCounts[] = {1, 2, 4};
+
+    std::cout << "Policy Benchmark (" << cacau::jobs::job_system_traits::name() << " configuration)\n"
+              << "Profiling: " << cacau::jobs::job_system_traits::kProfiling
+              << ", Tracing: " << cacau::jobs::job_system_traits::kTracing
+              << ", Priority queues: " << cacau::jobs::job_system_traits::kPriorityQueues
+              << ", Sleeping workers: " << (cacau::jobs::job_system_traits::kWakePolicy == cacau::jobs::wake_policy::sleep)
+              << ", Pooled jobs: " << (cacau::jobs::job_system_traits::kAllocatorPolicy == cacau::jobs::allocator_policy::pool)
+              << "\n"
+              << "Worker scratch: " << cacau::jobs::job_system_traits::kWorkerScratch
+              << ", Timers: " << cacau::jobs::job_system_traits::kTimers
+              << ", Task arenas: " << cacau::jobs::job_system_traits::kTaskArenas
+              << ", sizeof(job): " << sizeof(cacau::jobs::job) << " bytes\n";
+
+    test_compiled_out_features();
+
+    for (size_t threads : threadCounts)
+    {
+        double nanoseconds = measure_overhead(threads, kJobs);
+        std::cout << "Threads: " << threads << ", "
+                  << "Jobs: " << kJobs << ", "
+                  << "Overhead: " << nanoseconds << " ns/job\n";
+    }
+
+    return test_util::report("Policy Benchmark");
+}
@@ -0,0 +1,101 @@
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+
+#ifdef _WIN32
+    #define popen _popen
+    #define pclose _pclose
+#endif
+
+/**
+ * @brief Output of one policy benchmark build
+ */
+struct benchmark_run
+{
+    std::string mConfiguration;          ///< Header lines, name and features of the configuration
+    std::map<size_t, double> mOverheads; ///< ns/job by thread count
+    bool mPassed = false;
+};
+
+/**
+ * @brief Runs a TestPolicyBenchmark build and parses its "Threads: N, Jobs: M, Overhead: X ns/job" lines
+ */
+benchmark_run run_benchmark(const char* pCommand)
+{
+    benchmark_run run;
+    FILE *output = popen((std::string("\"") + pCommand + "\"").c_str(), "r");
+    if (output == nullptr)
+    {
+        std::cout << "FAILED: cannot run " << pCommand << "\n";
+        return run;
+    }
+
+    char line[512];
+    while (std::fgets(line, sizeof(line), output) != nullptr)
+    {
+        size_t threads = 0;
+        size_t jobs = 0;
+        double overhead = 0.0;
+        if (std::sscanf(line, "Threads: %zu, Jobs: %zu, Overhead: %lf", &threads, &jobs, &overhead) == 3)
+        {
+            run.mOverheads[threads] = overhead;
+        }
+        else if (std::string(line).find("FAILED") != std::string::npos)
+        {
+            std::cout << pCommand << ": " << line;
+        }
+        else if (run.mOverheads.empty())
+        {
+            std::string header(line, std::string(line).find_last_not_of("\r\n") + 1);
+            run.mConfiguration += run.mConfiguration.empty() ? header : "\n     " + header;
+        }
+    }
+    run.mPassed = pclose(output) == 0;
+    return run;
+}
+
+/**
+ * @brief Prints the per-job overhead of the full and the minimal configuration side by side
+ * @details The configuration is chosen at compile time, so both builds run as separate processes
+ */
+int main(int pArgCount, char** pArgs)
+{
+    if (pArgCount != 3)
+    {
+        std::cout << "Usage: TestPolicyComparison <TestPolicyBenchmarkFull> <TestPolicyBenchmarkMinimal>\n";
+        return 1;
+    }
+
+    benchmark_run full = run_benchmark(pArgs[1]);
+    benchmark_run minimal = run_benchmark(pArgs[2]);
+
+    std::cout << "Policy Comparison\n"
+              << "  A: " << full.mConfiguration << "\n"
+              << "  B: " << minimal.mConfiguration << "\n\n"
+              << std::left << std::setw(10) << "Threads"
+              << std::right << std::setw(14) << "A ns/job"
+              << std::setw(14) << "B ns/job"
+              << std::setw(12) << "B / A" << "\n";
+
+    std::cout << std::fixed << std::setprecision(1);
+    for (const auto &entry : full.mOverheads)
+    {
+        auto other = minimal.mOverheads.find(entry.first);
+        if (other == minimal.mOverheads.end())
+        {
+            continue;
+        }
+        std::cout << std::left << std::setw(10) << entry.first
+                  << std::right << std::setw(14) << entry.second
+                  << std::setw(14) << other->second
+                  << std::setw(11) << std::setprecision(2) << other->second / entry.second << "x"
+                  << std::setprecision(1) << "\n";
+    }
+
+    bool passed = full.mPassed && minimal.mPassed && !full.mOverheads.empty() &&
+                  full.mOverheads.size() == minimal.mOverheads.size();
+    std::cout << (passed ? "Policy Comparison Test Completed.\n" : "Policy Comparison Test FAILED.\n");
+    return passed ? 0 : 1;
+}
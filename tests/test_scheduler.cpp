@@ -1,5 +1,13 @@
 #include <iostream>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
 #include "cacau_jobs.h"
+#include "test_util.h"
+
+using test_util::check;
 
 void test_job_scheduler_runner(cacau::jobs::job_system &jobSystem)
 {
@@ -28,12 +36,137 @@ void test_job_scheduler_runner(cacau::jobs::job_system &jobSystem)
     jobSystem.submit_with_dependencies(job3, {job1, job2});
 }
 
+/**
+ * @brief A ready dependant is queued behind the jobs already queued, not run inside its dependency
+ */
+void test_dependants_are_queued()
+{
+    cacau::jobs::job_system jobSystem(1);
+    std::mutex orderMutex;
+    std::string order;
+    auto logged = [&orderMutex, &order](char pLabel)
+    {
+        return [&orderMutex, &order, pLabel]
+        {
+            std::lock_guard<std::mutex> lock(orderMutex);
+            order += pLabel;
+        };
+    };
+
+    auto *dependency = new cacau::jobs::job(logged('D'), "Dependency");
+    auto *dependant = new cacau::jobs::job(logged('X'), "Dependant");
+    jobSystem.submit_with_dependencies(dependant, {dependency});
+    jobSystem.submit(dependency);
+    jobSystem.submit(new cacau::jobs::job(logged('P'), "Plain"));
+    jobSystem.wait_for_all_jobs();
+
+    check(order == "DPX", "ready dependant runs from the queue, after the jobs queued before it");
+    delete dependant;
+}
+
+/**
+ * @brief Jobs waiting for dependencies count as pending until they ran, then belong to their owner
+ */
+void test_waiting_jobs_are_pending()
+{
+    cacau::jobs::job_system jobSystem(2);
+    auto *dependency = new cacau::jobs::job([] {}, "Dependency");
+    auto *dependant = new cacau::jobs::job([] {}, "Dependant");
+    jobSystem.submit_with_dependencies(dependant, {dependency});
+    jobSystem.submit(dependency);
+
+    check(jobSystem.get_pending_jobs() == 2, "queued and waiting jobs are pending");
+    jobSystem.wait_for_all_jobs();
+    check(jobSystem.get_pending_jobs() == 0, "no job pending after waiting");
+    delete dependant;
+}
+
+/**
+ * @brief resume() wakes workers parked while the job system was paused
+ */
+void test_resume_wakes_workers()
+{
+    cacau::jobs::job_system jobSystem(2);
+    std::atomic<bool> ran(false);
+    jobSystem.submit(new cacau::jobs::job([&ran] { ran = true; }, "Parked"));
+
+    // Give the workers time to go to sleep
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    jobSystem.resume();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!ran && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    check(ran, "resumed workers run the queued job without wait_for_all_jobs");
+    jobSystem.wait_for_all_jobs();
+}
+
+/**
+ * @brief wait_for_all_jobs() returns only after the running jobs finished, not once the queues are empty
+ */
+void test_wait_includes_running_jobs()
+{
+    cacau::jobs::job_system jobSystem(1);
+    jobSystem.resume();
+    std::atomic<bool> started(false);
+    std::atomic<bool> finished(false);
+    jobSystem.submit(new cacau::jobs::job([&started, &finished]
+                                          {
+                                              started = true;
+                                              std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                                              finished = true;
+                                          }, "Running"));
+    while (!started)
+    {
+        std::this_thread::yield();
+    }
+
+    // The queue is empty now, the job is still running
+    jobSystem.wait_for_all_jobs();
+    check(finished, "wait_for_all_jobs waits for the job a worker is running");
+}
+
+/**
+ * @brief A job submitted while every worker sleeps wakes one of them
+ */
+void test_submit_wakes_sleeping_workers()
+{
+    cacau::jobs::job_system jobSystem(2);
+    jobSystem.resume();
+    std::atomic<int> ran(0);
+    const int kRounds = 200;
+    for (int round = 0; round < kRounds; ++round)
+    {
+        // Let the workers run out of work and go to sleep between submits
+        if (round % 20 == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        jobSystem.submit(new cacau::jobs::job([&ran] { ++ran; }, "Wake"));
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (ran <= round && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+    }
+    check(ran == kRounds, "every submit wakes a worker without wait_for_all_jobs");
+}
+
 int main()
 {
     std::cout << "Scheduler Test Started.\n";
     cacau::jobs::job_system job_system(4); // Example thread count
     test_job_scheduler_runner(job_system);
     job_system.wait_for_all_jobs();
-    std::cout << "Scheduler Test Completed.\n";
-    return 0;
+
+    test_dependants_are_queued();
+    test_waiting_jobs_are_pending();
+    test_resume_wakes_workers();
+    test_wait_includes_running_jobs();
+    test_submit_wakes_sleeping_workers();
+
+    return test_util::report("Scheduler");
 }
\ No newline at end of file
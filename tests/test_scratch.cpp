@@ -0,0 +1,261 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "cacau_jobs.h"
+#include "test_util.h"
+
+using test_util::check;
+
+namespace
+{
+    bool is_aligned(const void* pAddress, size_t pAlignment)
+    {
+        return reinterpret_cast<uintptr_t>(pAddress) % pAlignment == 0;
+    }
+}
+
+/**
+ * @brief Alignment, growth past one block, rewind and reset
+ */
+void test_arena()
+{
+    cacau::jobs::scratch_arena arena(1024);
+
+    char* byte = static_cast<char*>(arena.allocate(1, 1));
+    double* values = arena.allocate_array<double>(16);
+    check(is_aligned(values, alignof(double)), "array is aligned for its element");
+    check(is_aligned(arena.allocate(8, 64), 64), "explicit alignment is honored");
+
+    cacau::jobs::scratch_arena::marker_type marker = arena.marker();
+    size_t usedAtMarker = arena.used();
+    int* big = arena.allocate_array<int>(4096);
+    check(arena.capacity() > 1024, "oversized request gets its own block");
+    big[4095] = 7;
+    arena.rewind(marker);
+    check(arena.used() == usedAtMarker, "rewind frees everything after the marker");
+
+    size_t capacity = arena.capacity();
+    arena.reset();
+    check(arena.used() == 0, "reset frees everything");
+    check(arena.allocate(1, 1) == byte, "reset reuses the first block");
+    for (int i = 0; i < 100; ++i)
+    {
+        arena.allocate(64);
+    }
+    check(arena.capacity() == capacity, "warm arena does not allocate more blocks");
+}
+
+/**
+ * @brief Every job starts with an empty scratch arena and keeps its own data intact
+ */
+void test_job_scratch(size_t pThreads, size_t pJobs)
+{
+    cacau::jobs::job_system jobSystem(pThreads);
+    std::atomic<int> errors(0);
+
+    for (size_t i = 0; i < pJobs; ++i)
+    {
+        jobSystem.submit(new cacau::jobs::job([&errors, i]
+        {
+            cacau::jobs::scratch_arena &scratch = cacau::jobs::job_system::scratch();
+            if (scratch.used() != 0)
+            {
+                ++errors;
+            }
+
+            size_t count = 256 + i % 512;
+            uint32_t* values = scratch.allocate_array<uint32_t>(count);
+            for (size_t k = 0; k < count; ++k)
+            {
+                values[k] = static_cast<uint32_t>(i * k);
+            }
+            for (size_t k = 0; k < count; ++k)
+            {
+                if (values[k] != static_cast<uint32_t>(i * k))
+                {
+                    ++errors;
+                    break;
+                }
+            }
+        }, "ScratchJob"));
+    }
+    jobSystem.wait_for_all_jobs();
+
+    check(errors == 0, "job scratch is empty on entry and private to the job");
+    check(&cacau::jobs::job_system::scratch() == &cacau::jobs::job_system::scratch(),
+          "non-worker threads get a stable arena");
+}
+
+/**
+ * @brief Frame allocations survive across jobs until the next begin_frame()
+ */
+void test_frame_scratch()
+{
+    cacau::jobs::job_system jobSystem(1);
+    std::atomic<size_t> used(0);
+    int* shared = nullptr;
+
+    auto run = [&jobSystem](std::function<void()> pFunction)
+    {
+        jobSystem.submit(new cacau::jobs::job(pFunction, "FrameJob"));
+        jobSystem.wait_for_all_jobs();
+    };
+
+    run([&shared]
+    {
+        shared = cacau::jobs::job_system::frame_scratch().allocate_array<int>(64);
+        shared[63] = 42;
+    });
+    run([&used, &shared]
+    {
+        used = cacau::jobs::job_system::frame_scratch().used();
+        if (shared[63] != 42)
+        {
+            used = 0;
+        }
+    });
+    check(used >= 64 * sizeof(int), "frame data is visible to later jobs of the same frame");
+
+    jobSystem.begin_frame();
+    check(jobSystem.frame_index() == 1, "begin_frame advances the frame index");
+    run([&used]
+    {
+        used = cacau::jobs::job_system::frame_scratch().used();
+    });
+    check(used == 0, "begin_frame frees the frame arena");
+}
+
+/**
+ * @brief Blocks allocated by one set of jobs and freed by another, across workers and rounds
+ */
+void test_blocks(size_t pThreads, size_t pRounds, size_t pBlocksPerJob)
+{
+    cacau::jobs::job_system jobSystem(pThreads);
+    std::atomic<int> errors(0);
+    const size_t sizes[] = {1, 16, 24, 100, 512, 2048, 5000};
+    const size_t sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+
+    for (size_t round = 0; round < pRounds; ++round)
+    {
+        std::vector<std::vector<unsigned char*>> blocks(pThreads * 2);
+        for (size_t j = 0; j < blocks.size(); ++j)
+        {
+            jobSystem.submit_to(j, new cacau::jobs::job([&blocks, &sizes, sizeCount, j, pBlocksPerJob, &errors]
+            {
+                for (size_t b = 0; b < pBlocksPerJob; ++b)
+                {
+                    size_t size = sizes[b % sizeCount];
+                    unsigned char* block = static_cast<unsigned char*>(cacau::jobs::job_system::allocate_block(size));
+                    if (!is_aligned(block, 16))
+                    {
+                        ++errors;
+                    }
+                    std::memset(block, static_cast<int>(j + b) & 0xff, size);
+                    blocks[j].push_back(block);
+                }
+            }, "AllocateBlocks"));
+        }
+        jobSystem.wait_for_all_jobs();
+
+        // Free from a different worker than the one that allocated
+        for (size_t j = 0; j < blocks.size(); ++j)
+        {
+            jobSystem.submit_to(j + 1, new cacau::jobs::job([&blocks, &sizes, sizeCount, j, &errors]
+            {
+                for (size_t b = 0; b < blocks[j].size(); ++b)
+                {
+                    size_t size = sizes[b % sizeCount];
+                    if (blocks[j][b][0] != ((j + b) & 0xff) || blocks[j][b][size - 1] != ((j + b) & 0xff))
+                    {
+                        ++errors;
+                    }
+                    cacau::jobs::job_system::deallocate_block(blocks[j][b]);
+                }
+            }, "FreeBlocks"));
+        }
+        jobSystem.wait_for_all_jobs();
+    }
+
+    // Outside a worker blocks come from the heap, and worker blocks can be freed from here
+    void* heapBlock = cacau::jobs::job_system::allocate_block(64);
+    check(is_aligned(heapBlock, 16), "heap fallback block is aligned");
+    cacau::jobs::job_system::deallocate_block(heapBlock);
+
+    void* workerBlock = nullptr;
+    jobSystem.submit(new cacau::jobs::job([&workerBlock]
+    {
+        workerBlock = cacau::jobs::job_system::allocate_block(32);
+    }, "AllocateBlock"));
+    jobSystem.wait_for_all_jobs();
+    cacau::jobs::job_system::deallocate_block(workerBlock);
+
+    check(errors == 0, "blocks are aligned, private and intact until freed");
+}
+
+/**
+ * @brief Temporary buffers from the heap versus the worker's scratch arena
+ */
+void benchmark_temporaries(size_t pThreads, size_t pJobs, size_t pFloats)
+{
+    auto run = [pThreads, pJobs, pFloats](bool pUseScratch)
+    {
+        cacau::jobs::job_system jobSystem(pThreads);
+        std::atomic<uint64_t> sink(0);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < pJobs; ++i)
+        {
+            jobSystem.submit(new cacau::jobs::job([pUseScratch, pFloats, &sink]
+            {
+                float* buffer;
+                std::vector<float> heapBuffer;
+                if (pUseScratch)
+                {
+                    buffer = cacau::jobs::job_system::scratch().allocate_array<float>(pFloats);
+                }
+                else
+                {
+                    heapBuffer.resize(pFloats);
+                    buffer = heapBuffer.data();
+                }
+                float sum = 0.0f;
+                for (size_t k = 0; k < pFloats; ++k)
+                {
+                    buffer[k] = static_cast<float>(k);
+                    sum += buffer[k];
+                }
+                sink.fetch_add(static_cast<uint64_t>(sum), std::memory_order_relaxed);
+            }, "TemporaryBuffer"));
+        }
+        jobSystem.wait_for_all_jobs();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    };
+
+    double heapTime = run(false);
+    double scratchTime = run(true);
+    std::cout << "Threads: " << pThreads << ", "
+              << "Jobs: " << pJobs << ", "
+              << "Buffer: " << pFloats * sizeof(float) << " bytes, "
+              << "Heap: " << heapTime << " ms, "
+              << "Scratch: " << scratchTime << " ms\n";
+}
+
+int main()
+{
+    std::cout << "Scratch Test Started.\n";
+
+    test_arena();
+    test_job_scratch(1, 2000);
+    test_job_scratch(4, 2000);
+    test_frame_scratch();
+    test_blocks(1, 20, 200);
+    test_blocks(4, 20, 200);
+
+    benchmark_temporaries(4, 20000, 64);
+    benchmark_temporaries(4, 2000, 64 * 1024);
+
+    return test_util::report("Scratch");
+}
@@ -0,0 +1,365 @@
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cacau_jobs.h"
+#include "test_util.h"
+
+using test_util::check;
+using test_util::spin;
+using test_util::time_ms;
+
+namespace
+{
+    // Set on a thread while one of its jobs waits on an arena
+    thread_local bool tInsideArenaWait = false;
+
+    /**
+     * @brief Records the order in which jobs of several sources run
+     */
+    struct run_log
+    {
+        std::mutex mMutex;
+        std::string mOrder;
+
+        void add(char pSource)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mOrder += pSource;
+        }
+
+        size_t count(char pSource, size_t pFirst) const
+        {
+            return std::count(mOrder.begin(), mOrder.begin() + std::min(pFirst, mOrder.size()), pSource);
+        }
+    };
+}
+
+/**
+ * @brief An arena never runs more jobs at once than its limit
+ */
+void test_concurrency_limit(size_t pThreads, size_t pLimit)
+{
+    cacau::jobs::job_system jobSystem(pThreads);
+    cacau::jobs::task_arena arena(jobSystem, pLimit, 1, "Limited");
+    std::atomic<int> running(0);
+    std::atomic<int> maxRunning(0);
+    std::atomic<int> ran(0);
+
+    for (int i = 0; i < 200; ++i)
+    {
+        arena.submit(new cacau::jobs::job([&running, &maxRunning, &ran]
+        {
+            int current = ++running;
+            int previous = maxRunning.load();
+            while (current > previous && !maxRunning.compare_exchange_weak(previous, current))
+            {
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            --running;
+            ++ran;
+        }, "LimitedJob"));
+    }
+    check(arena.get_pending_jobs() == 200, "arena jobs wait in the arena queue");
+    check(jobSystem.get_pending_jobs() == 200, "job system counts arena jobs as pending");
+
+    arena.wait_for_all_jobs();
+    check(ran == 200, "every arena job runs");
+    check(arena.completed_jobs() == 200, "arena counts its completed jobs");
+    check(maxRunning <= static_cast<int>(pLimit), "arena stays within its concurrency limit");
+    check(arena.get_running_jobs() == 0 && arena.get_pending_jobs() == 0, "arena is idle after waiting");
+}
+
+/**
+ * @brief Arenas with queued jobs get turns in proportion to their weight
+ */
+void test_weights()
+{
+    // One worker makes the order of turns deterministic
+    cacau::jobs::job_system jobSystem(1);
+    cacau::jobs::task_arena heavy(jobSystem, 0, 3, "Heavy");
+    cacau::jobs::task_arena light(jobSystem, 0, 1, "Light");
+    run_log log;
+
+    for (int i = 0; i < 400; ++i)
+    {
+        heavy.submit(new cacau::jobs::job([&log] { log.add('H'); }, "HeavyJob"));
+        light.submit(new cacau::jobs::job([&log] { log.add('L'); }, "LightJob"));
+    }
+    jobSystem.wait_for_all_jobs();
+
+    size_t heavyShare = log.count('H', 400);
+    check(heavyShare >= 290 && heavyShare <= 310, "weight 3 arena gets three of every four turns");
+    check(log.mOrder.size() == 800, "job system waits for arena jobs");
+
+    // The job system's own queues take every other turn
+    log.mOrder.clear();
+    for (int i = 0; i < 200; ++i)
+    {
+        light.submit(new cacau::jobs::job([&log] { log.add('L'); }, "LightJob"));
+        jobSystem.submit(new cacau::jobs::job([&log] { log.add('S'); }, "SystemJob"));
+    }
+    jobSystem.wait_for_all_jobs();
+
+    size_t systemShare = log.count('S', 200);
+    check(systemShare >= 95 && systemShare <= 105, "arenas and the job system's queues take turns");
+}
+
+/**
+ * @brief Waiting on an arena from a worker runs only that arena's jobs, even at its concurrency limit
+ */
+void test_isolation(size_t pThreads)
+{
+    cacau::jobs::job_system jobSystem(pThreads);
+    cacau::jobs::task_arena physics(jobSystem, 1, 1, "Physics");
+    cacau::jobs::task_arena ai(jobSystem, 0, 1, "AI");
+    std::atomic<int> children(0);
+    std::atomic<int> leaked(0);
+    std::atomic<int> aiRan(0);
+
+    for (int i = 0; i < 50; ++i)
+    {
+        ai.submit(new cacau::jobs::job([&leaked, &aiRan]
+        {
+            if (tInsideArenaWait)
+            {
+                ++leaked;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            ++aiRan;
+        }, "AIJob"));
+    }
+
+    // The parent holds the arena's only slot and lends it to its children while waiting
+    physics.submit(new cacau::jobs::job([&physics, &children]
+    {
+        for (int i = 0; i < 20; ++i)
+        {
+            physics.submit(new cacau::jobs::job([&children] { ++children; }, "PhysicsChild"));
+        }
+        tInsideArenaWait = true;
+        physics.wait_for_all_jobs();
+        tInsideArenaWait = false;
+    }, "PhysicsParent"));
+
+    physics.wait_for_all_jobs();
+    ai.wait_for_all_jobs();
+
+    check(children == 20, "nested arena wait runs the arena's jobs at its concurrency limit");
+    check(leaked == 0, "waiting on an arena never runs another arena's jobs");
+    check(aiRan == 50, "other arena's jobs still run");
+}
+
+/**
+ * @brief A few jobs submitted behind another arena's burst run within the next turns
+ * @details benchmark() measures the same in wall-clock time, this checks the order of turns
+ */
+void test_burst_isolation()
+{
+    // One worker makes the order of turns deterministic
+    cacau::jobs::job_system jobSystem(1);
+    cacau::jobs::task_arena physics(jobSystem, 0, 1, "Physics");
+    cacau::jobs::task_arena ai(jobSystem, 0, 1, "AI");
+    run_log log;
+
+    for (int i = 0; i < 500; ++i)
+    {
+        physics.submit(new cacau::jobs::job([&log] { log.add('P'); }, "PhysicsBurst"));
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        ai.submit(new cacau::jobs::job([&log] { log.add('A'); }, "AIJob"));
+    }
+    jobSystem.wait_for_all_jobs();
+
+    check(log.mOrder.size() == 510, "every burst and AI job runs");
+    check(log.count('A', 20) == 10, "AI jobs are not queued behind the other arena's burst");
+}
+
+/**
+ * @brief Jobs run while an outer job waits on an arena keep the outer job's scratch allocations
+ * @details One worker, so the arena job runs nested inside the outer job's wait. The frame
+ *          advances while the outer job runs, its frame allocations stay valid until it returns
+ */
+void test_nested_scratch()
+{
+    const size_t kCount = 256;
+    cacau::jobs::job_system jobSystem(1);
+    cacau::jobs::task_arena arena(jobSystem, 0, 1, "Nested");
+    std::atomic<bool> frameIntact(false);
+    std::atomic<bool> jobIntact(false);
+    std::atomic<bool> jobRewound(false);
+    std::atomic<bool> innerRan(false);
+
+    // Overwrites whatever the outer job's allocations would share memory with if they were freed
+    auto fill = [](int* pValues, size_t pCount, int pValue)
+    {
+        for (size_t i = 0; i < pCount; ++i)
+        {
+            pValues[i] = pValue;
+        }
+    };
+    auto holds = [](const int* pValues, size_t pCount, int pValue)
+    {
+        for (size_t i = 0; i < pCount; ++i)
+        {
+            if (pValues[i] != pValue)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    jobSystem.submit(new cacau::jobs::job([&]
+    {
+        cacau::jobs::scratch_arena &frameScratch = cacau::jobs::job_system::frame_scratch();
+        cacau::jobs::scratch_arena &jobScratch = cacau::jobs::job_system::scratch();
+        int* frameValues = frameScratch.allocate_array<int>(kCount);
+        int* jobValues = jobScratch.allocate_array<int>(kCount);
+        fill(frameValues, kCount, 1);
+        fill(jobValues, kCount, 2);
+        size_t jobScratchUsed = jobScratch.used();
+
+        jobSystem.begin_frame();
+        arena.submit(new cacau::jobs::job([&fill, &innerRan, kCount]
+        {
+            fill(cacau::jobs::job_system::frame_scratch().allocate_array<int>(kCount), kCount, 3);
+            fill(cacau::jobs::job_system::scratch().allocate_array<int>(kCount), kCount, 4);
+            innerRan = true;
+        }, "InnerJob"));
+        arena.wait_for_all_jobs();
+
+        frameIntact = holds(frameValues, kCount, 1);
+        jobIntact = holds(jobValues, kCount, 2);
+        jobRewound = jobScratch.used() == jobScratchUsed;
+    }, "OuterJob"));
+    jobSystem.wait_for_all_jobs();
+
+    check(innerRan, "arena job runs inside the outer job's wait");
+    check(frameIntact, "nested job does not free the outer job's frame scratch after begin_frame()");
+    check(jobIntact, "nested job does not overwrite the outer job's scratch");
+    check(jobRewound, "nested job's scratch is rewound to the outer job's marker");
+}
+
+/**
+ * @brief Latency of a small job set behind a burst, and throughput of three subsystems
+ *        sharing one pool against each creating its own job system
+ */
+void benchmark(size_t pThreads)
+{
+    const int kWork = 20000;
+    std::cout << "Threads: " << pThreads << "\n";
+
+    // Burst: physics floods the workers, then AI submits a few jobs
+    double sharedLatency = 0.0;
+    double arenaLatency = 0.0;
+    {
+        cacau::jobs::job_system jobSystem(pThreads);
+        jobSystem.resume();
+        std::atomic<int> aiDone(0);
+        for (int i = 0; i < 2000; ++i)
+        {
+            jobSystem.submit(new cacau::jobs::job([kWork] { spin(kWork); }, "PhysicsBurst"));
+        }
+        sharedLatency = time_ms([&]
+        {
+            for (int i = 0; i < 10; ++i)
+            {
+                jobSystem.submit(new cacau::jobs::job([&aiDone, kWork] { spin(kWork); ++aiDone; }, "AIJob"));
+            }
+            while (aiDone < 10)
+            {
+                std::this_thread::yield();
+            }
+        });
+        jobSystem.wait_for_all_jobs();
+    }
+    {
+        cacau::jobs::job_system jobSystem(pThreads);
+        cacau::jobs::task_arena physics(jobSystem, 0, 1, "Physics");
+        cacau::jobs::task_arena ai(jobSystem, 0, 1, "AI");
+        jobSystem.resume();
+        for (int i = 0; i < 2000; ++i)
+        {
+            physics.submit(new cacau::jobs::job([kWork] { spin(kWork); }, "PhysicsBurst"));
+        }
+        arenaLatency = time_ms([&]
+        {
+            for (int i = 0; i < 10; ++i)
+            {
+                ai.submit(new cacau::jobs::job([kWork] { spin(kWork); }, "AIJob"));
+            }
+            ai.wait_for_all_jobs();
+        });
+        physics.wait_for_all_jobs();
+    }
+    // Timing only, test_burst_isolation() checks the order deterministically
+    std::cout << "  AI jobs behind a 2000 job burst: shared queues " << sharedLatency << " ms, "
+              << "arenas " << arenaLatency << " ms\n";
+
+    // Three subsystems, each with 1000 jobs
+    double separateMs = time_ms([&]
+    {
+        std::vector<std::unique_ptr<cacau::jobs::job_system>> systems;
+        for (int s = 0; s < 3; ++s)
+        {
+            systems.emplace_back(new cacau::jobs::job_system(pThreads));
+            for (int i = 0; i < 1000; ++i)
+            {
+                systems.back()->submit(new cacau::jobs::job([kWork] { spin(kWork); }, "SubsystemJob"));
+            }
+        }
+        for (auto &system : systems)
+        {
+            system->resume();
+        }
+        for (auto &system : systems)
+        {
+            system->wait_for_all_jobs();
+        }
+    });
+    double arenasMs = time_ms([&]
+    {
+        cacau::jobs::job_system jobSystem(pThreads);
+        std::vector<std::unique_ptr<cacau::jobs::task_arena>> arenas;
+        for (int s = 0; s < 3; ++s)
+        {
+            arenas.emplace_back(new cacau::jobs::task_arena(jobSystem, 0, 1, "Subsystem"));
+            for (int i = 0; i < 1000; ++i)
+            {
+                arenas.back()->submit(new cacau::jobs::job([kWork] { spin(kWork); }, "SubsystemJob"));
+            }
+        }
+        jobSystem.resume();
+        for (auto &arena : arenas)
+        {
+            arena->wait_for_all_jobs();
+        }
+    });
+    std::cout << "  3 subsystems x 1000 jobs: " << 3 * pThreads << " threads in 3 job systems "
+              << separateMs << " ms, " << pThreads << " threads with 3 arenas " << arenasMs << " ms\n";
+}
+
+int main()
+{
+    std::cout << "Task Arena Test Started.\n";
+
+    test_concurrency_limit(4, 2);
+    test_concurrency_limit(4, 1);
+    test_concurrency_limit(1, 4);
+    test_weights();
+    test_isolation(1);
+    test_isolation(4);
+    test_burst_isolation();
+    test_nested_scratch();
+
+    benchmark(std::max(2u, std::thread::hardware_concurrency()));
+
+    return test_util::report("Task Arena");
+}
@@ -0,0 +1,275 @@
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "cacau_jobs.h"
+#include "test_util.h"
+
+using test_util::check;
+
+namespace
+{
+    using steady = std::chrono::steady_clock;
+
+    /**
+     * @brief Lateness of timed jobs, recorded from the workers
+     */
+    struct jitter_recorder
+    {
+        std::mutex mMutex;
+        cacau::jobs::latency_histogram mHistogram;
+        int mEarly = 0;
+
+        void record(steady::time_point pDue)
+        {
+            auto now = steady::now();
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (now < pDue)
+            {
+                ++mEarly;
+                return;
+            }
+            mHistogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - pDue).count()));
+        }
+
+        /**
+         * @brief Records how far the gap since the previous run is off the interval, either way
+         */
+        void record_interval(steady::time_point &pPrevious, steady::duration pInterval)
+        {
+            auto now = steady::now();
+            steady::duration error = now - pPrevious - pInterval;
+            pPrevious = now;
+            std::lock_guard<std::mutex> lock(mMutex);
+            mHistogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                error < steady::duration::zero() ? -error : error).count()));
+        }
+
+        void print(const char* pLabel)
+        {
+            std::cout << "  " << pLabel << ": "
+                      << "samples " << mHistogram.count() << ", "
+                      << "p50 " << mHistogram.percentile(50.0) / 1000.0 << " us, "
+                      << "p99 " << mHistogram.percentile(99.0) / 1000.0 << " us, "
+                      << "max " << mHistogram.max() / 1000.0 << " us\n";
+        }
+    };
+}
+
+/**
+ * @brief Random timers fire exactly once, never early, in any level or the overflow list
+ */
+void test_wheel(uint32_t pSeed)
+{
+    std::mt19937_64 generator(pSeed);
+    cacau::jobs::timer_wheel<int> wheel;
+    std::map<int, uint64_t> pending;
+    const uint64_t ranges[] = {10, 100, 5000, 300000, 20000000, 100000000};
+    uint64_t now = 0;
+    int nextId = 0;
+    bool correct = true;
+    bool boundOk = true;
+
+    for (int step = 0; step < 3000 && correct; ++step)
+    {
+        for (uint64_t i = generator() % 3; i > 0; --i)
+        {
+            uint64_t expiry = now + generator() % ranges[generator() % 6];
+            pending[nextId] = expiry;
+            wheel.schedule(expiry, nextId++);
+        }
+
+        uint64_t nextExpiry;
+        if (wheel.next_expiry(nextExpiry))
+        {
+            uint64_t earliest = ~uint64_t(0);
+            for (const auto &timer : pending)
+            {
+                earliest = std::min(earliest, timer.second);
+            }
+            boundOk = boundOk && nextExpiry <= std::max(earliest, now);
+        }
+
+        uint64_t target = now + (generator() % 4 == 0 ? generator() % 2000000 : generator() % 100);
+        wheel.advance(target, [&](uint64_t pExpiry, int &pId)
+        {
+            auto found = pending.find(pId);
+            correct = correct && found != pending.end() && found->second == pExpiry && pExpiry <= target;
+            if (found != pending.end())
+            {
+                pending.erase(found);
+            }
+        });
+        now = target;
+
+        for (const auto &timer : pending)
+        {
+            correct = correct && timer.second > now;
+        }
+        correct = correct && wheel.size() == pending.size();
+    }
+
+    check(correct, "timer wheel expires every timer once, on time");
+    check(boundOk, "next_expiry is never later than the earliest timer");
+}
+
+/**
+ * @brief Delayed jobs run after their delay and are waited for
+ */
+void test_submit_after(size_t pThreads)
+{
+    cacau::jobs::job_system jobSystem(pThreads);
+    jobSystem.resume();
+
+    const int delaysMs[] = {0, 1, 5, 20, 3, 40};
+    std::atomic<int> ran(0);
+    std::atomic<int> early(0);
+    for (int delay : delaysMs)
+    {
+        steady::time_point due = steady::now() + std::chrono::milliseconds(delay);
+        jobSystem.submit_after(std::chrono::milliseconds(delay), new cacau::jobs::job([&ran, &early, due]
+        {
+            if (steady::now() < due)
+            {
+                ++early;
+            }
+            ++ran;
+        }, "DelayedJob"));
+    }
+    jobSystem.wait_for_all_jobs();
+
+    check(ran == 6, "wait_for_all_jobs waits for delayed jobs");
+    check(early == 0, "delayed jobs never run early");
+    check(jobSystem.get_pending_timers() == 0, "no timers left");
+}
+
+/**
+ * @brief Periodic jobs repeat at their interval, stop when cancelled and are owned by the job system
+ */
+void test_submit_periodic()
+{
+    std::shared_ptr<int> sentinel = std::make_shared<int>(0);
+    std::atomic<int> runs(0);
+    {
+        cacau::jobs::job_system jobSystem(2);
+        jobSystem.resume();
+
+        uint64_t timerId = jobSystem.submit_periodic(std::chrono::milliseconds(5),
+            new cacau::jobs::job([&runs, sentinel] { ++runs; }, "PeriodicJob"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        check(jobSystem.cancel_periodic(timerId), "periodic timer is cancelled");
+        check(!jobSystem.cancel_periodic(timerId), "cancelled timer is gone");
+        int runsAtCancel = runs;
+        check(runsAtCancel >= 5 && runsAtCancel <= 21, "periodic job runs about once per interval");
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        check(runs <= runsAtCancel + 1, "cancelled job stops running");
+        check(sentinel.use_count() == 1, "cancelled periodic job is deleted");
+
+        // Owned by the job system until it is destroyed
+        jobSystem.submit_periodic(std::chrono::milliseconds(1), new cacau::jobs::job([sentinel] {}, "Periodic"));
+        jobSystem.submit_after(std::chrono::seconds(60), new cacau::jobs::job([sentinel] {}, "NeverDue"));
+    }
+    check(sentinel.use_count() == 1, "timer jobs are deleted with the job system");
+}
+
+/**
+ * @brief Lateness of one-shot and periodic timers, idle and under load, against a sleeping thread
+ */
+void benchmark_jitter(size_t pThreads)
+{
+    std::cout << "Threads: " << pThreads << "\n";
+    std::mt19937 generator(11);
+
+    // One-shot timers on idle workers
+    {
+        cacau::jobs::job_system jobSystem(pThreads);
+        jobSystem.resume();
+        jitter_recorder recorder;
+        for (int i = 0; i < 300; ++i)
+        {
+            auto delay = std::chrono::microseconds(1000 + generator() % 50000);
+            steady::time_point due = steady::now() + delay;
+            jobSystem.submit_after(delay, new cacau::jobs::job([&recorder, due] { recorder.record(due); }, "OneShot"));
+        }
+        jobSystem.wait_for_all_jobs();
+        check(recorder.mEarly == 0, "one-shot timers never fire early");
+        recorder.print("submit_after, idle");
+    }
+
+    // Periodic timer while the workers are busy with short jobs
+    {
+        cacau::jobs::job_system jobSystem(pThreads);
+        jobSystem.resume();
+        jitter_recorder recorder;
+        const auto interval = std::chrono::milliseconds(2);
+        steady::time_point start = steady::now();
+        steady::time_point previous = start;
+        uint64_t timerId = jobSystem.submit_periodic(interval, new cacau::jobs::job([&recorder, &previous, interval]
+        {
+            recorder.record_interval(previous, interval);
+        }, "Periodic"));
+
+        steady::time_point end = start + std::chrono::milliseconds(200);
+        while (steady::now() < end)
+        {
+            for (int i = 0; i < 32; ++i)
+            {
+                jobSystem.submit(new cacau::jobs::job([] { test_util::spin(20000); }, "Load"));
+            }
+            jobSystem.wait_for_all_jobs();
+        }
+        jobSystem.cancel_periodic(timerId);
+        recorder.print("submit_periodic 2 ms, busy, interval error");
+    }
+
+    // Baseline: a dedicated thread sleeping until each timer is due, then submitting
+    {
+        cacau::jobs::job_system jobSystem(pThreads);
+        jobSystem.resume();
+        jitter_recorder recorder;
+        std::vector<steady::time_point> dues;
+        steady::time_point now = steady::now();
+        for (int i = 0; i < 300; ++i)
+        {
+            dues.push_back(now + std::chrono::microseconds(1000 + generator() % 50000));
+        }
+        std::sort(dues.begin(), dues.end());
+
+        std::thread timerThread([&jobSystem, &recorder, &dues]
+        {
+            for (steady::time_point due : dues)
+            {
+                std::this_thread::sleep_until(due);
+                jobSystem.submit(new cacau::jobs::job([&recorder, due] { recorder.record(due); }, "ThreadTimer"));
+            }
+        });
+        timerThread.join();
+        jobSystem.wait_for_all_jobs();
+        recorder.print("dedicated timer thread, idle");
+    }
+}
+
+int main()
+{
+    std::cout << "Timer Test Started.\n";
+
+    test_wheel(1);
+    test_wheel(2);
+    test_submit_after(1);
+    test_submit_after(4);
+    test_submit_periodic();
+
+    benchmark_jitter(1);
+    benchmark_jitter(4);
+
+    return test_util::report("Timer");
+}
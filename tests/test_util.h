@@ -0,0 +1,64 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+
+/**
+ * @brief Helpers shared by the test executables
+ * @details Every test is its own executable: check() failures are counted per process and
+ *          report() turns them into the exit code seen by ctest
+ */
+namespace test_util
+{
+    /**
+     * @brief Number of failed checks so far
+     */
+    inline int &failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    inline void check(bool pCondition, const char* pMessage)
+    {
+        if (!pCondition)
+        {
+            std::cout << "FAILED: " << pMessage << "\n";
+            ++failures();
+        }
+    }
+
+    /**
+     * @brief Prints "<name> Test Completed." or "<name> Test FAILED."
+     * @return Exit code of the test, 0 if no check failed
+     */
+    inline int report(const char* pTestName)
+    {
+        std::cout << pTestName << (failures() == 0 ? " Test Completed.\n" : " Test FAILED.\n");
+        return failures() == 0 ? 0 : 1;
+    }
+
+    /**
+     * @brief Burns CPU for pIterations multiply-adds the compiler cannot remove
+     */
+    inline void spin(size_t pIterations)
+    {
+        volatile double sink = 0.0;
+        for (size_t i = 0; i < pIterations; ++i)
+        {
+            sink += static_cast<double>(i) * 0.5;
+        }
+    }
+
+    /**
+     * @brief Wall-clock time of a call in milliseconds
+     */
+    template <typename Function>
+    double time_ms(Function pFunction)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        pFunction();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+} // namespace test_util